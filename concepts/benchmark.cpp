@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+#include "poly.h"
+
+// Iterating a mixed collection of three animal types, stored as
+//   std::vector<std::unique_ptr<Base>>   one heap block per animal, virtual call
+//   std::vector<Poly<...>>               inline storage, call through the type's table
+// Pointers are measured twice: in allocation order, and shuffled, which is what a
+// long-running program's heap looks like after objects have come and gone.
+// usage: ./benchmark [animals]
+
+using Clock = std::chrono::steady_clock;
+
+template <typename T>
+concept Weighed = requires (const T& animal) {{animal.weight()} -> std::convertible_to<double>;};
+
+// Value types for Poly: no base class, no virtual functions.
+struct Cow   {double kg{650}; double weight() const {return kg;}};
+struct Sheep {double kg{70}; double wool{4}; double weight() const {return kg + wool;}};
+struct Goat  {double kg{60}; double horns{1}; double beard{0.1}; double weight() const {return kg + horns + beard;}};
+
+struct WeighedInterface
+{
+    template <typename T> static constexpr bool accepts = Weighed<T>;
+
+    struct VTable {double (*weight)(const void*);};
+
+    template <typename T>
+    static constexpr VTable vtable{[](const void* self){return static_cast<const T*>(self)->weight();}};
+
+    template <typename Self>
+    struct Methods
+    {
+        double weight() const
+        {
+            const Self& self = static_cast<const Self&>(*this);
+            return self.vtable().weight(self.object());
+        }
+    };
+};
+
+using AnyAnimal = Poly<WeighedInterface>;
+
+// The same three types in a classic hierarchy.
+struct Base
+{
+    virtual double weight() const = 0;
+    virtual ~Base() = default;
+};
+struct VCow : Base   {double kg{650}; double weight() const override {return kg;}};
+struct VSheep : Base {double kg{70}; double wool{4}; double weight() const override {return kg + wool;}};
+struct VGoat : Base  {double kg{60}; double horns{1}; double beard{0.1}; double weight() const override {return kg + horns + beard;}};
+
+template <typename Container>
+double nsPerElement(const Container& animals, double (*weight)(const typename Container::value_type&))
+{
+    constexpr int Runs = 5;
+    double sink = 0;
+    auto t0 = Clock::now();
+    for(int r = 0; r < Runs; ++r)
+    {
+        for(const auto& a : animals) sink += weight(a);
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / (Runs * animals.size());
+    if(sink == 42) std::puts(""); // keep the work observable
+    return ns;
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+    std::vector<int> kinds(n);
+    std::mt19937 rng{42};
+    for(int& k : kinds) k = rng() % 3;
+
+    auto t0 = Clock::now();
+    std::vector<std::unique_ptr<Base>> pointers;
+    pointers.reserve(n);
+    for(int k : kinds)
+    {
+        if(k == 0) pointers.push_back(std::make_unique<VCow>());
+        else if(k == 1) pointers.push_back(std::make_unique<VSheep>());
+        else pointers.push_back(std::make_unique<VGoat>());
+    }
+    double buildPointers = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / n;
+
+    t0 = Clock::now();
+    std::vector<AnyAnimal> values;
+    values.reserve(n);
+    for(int k : kinds)
+    {
+        if(k == 0) values.emplace_back(Cow{});
+        else if(k == 1) values.emplace_back(Sheep{});
+        else values.emplace_back(Goat{});
+    }
+    double buildValues = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / n;
+
+    auto viaPointer = [](const std::unique_ptr<Base>& a){return a->weight();};
+    auto viaPoly = [](const AnyAnimal& a){return a.weight();};
+    std::printf("%zu animals of 3 types, ns per animal     build   iterate\n", n);
+    std::printf("vector<unique_ptr<Base>>, allocation order  %6.2f  %8.2f\n", buildPointers, nsPerElement(pointers, viaPointer));
+    std::shuffle(pointers.begin(), pointers.end(), rng);
+    std::printf("vector<unique_ptr<Base>>, shuffled          %6s  %8.2f\n", "", nsPerElement(pointers, viaPointer));
+    std::printf("vector<Poly<WeighedInterface>>              %6.2f  %8.2f\n", buildValues, nsPerElement(values, viaPoly));
+}
+
+/*
+What to expect:
+    Build: make_unique is a malloc per animal; Poly only copies a few bytes into
+    the vector.
+    Iterate: both make one indirect call per animal, mispredicted about two times
+    in three with three types in random order. In allocation order the heap blocks
+    happen to be nearly contiguous and the prefetcher hides most of the pointer
+    chasing. Shuffled, each animal is a cache miss and unique_ptr becomes several
+    times slower; the Poly array is always walked sequentially.
+*/
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <concepts>
+#include <vector>
+#include "poly.h"
 
 /*
 Recall the following example from the CRTP:
@@ -65,6 +67,29 @@ public:
     void make_sound() const{std::cout << "baa\n";}
 };
 
+// Lets Poly hold any Animal: what it accepts, and how make_sound is called on it.
+struct AnimalInterface
+{
+    template <typename T> static constexpr bool accepts = Animal<T>;
+
+    struct VTable {void (*make_sound)(const void*);};
+
+    template <typename T>
+    static constexpr VTable vtable{[](const void* self){static_cast<const T*>(self)->make_sound();}};
+
+    template <typename Self>
+    struct Methods
+    {
+        void make_sound() const
+        {
+            const Self& self = static_cast<const Self&>(*this);
+            self.vtable().make_sound(self.object());
+        }
+    };
+};
+
+using AnyAnimal = Poly<AnimalInterface>;
+
 int main()
 {
     Cow betty;
@@ -73,4 +98,11 @@ int main()
     print(roshi);
     printauto(betty);
     printauto(roshi);
+
+    // print() and printauto() are instantiated once per type and need the type at
+    // compile time. A mixed herd needs type erasure: AnyAnimal stores any Animal
+    // inline, so the vector is one contiguous array with no allocation per animal.
+    std::vector<AnyAnimal> herd{Cow{}, Sheep{}, Cow{}};
+    for(const AnyAnimal& animal : herd) animal.make_sound();
+    // herd.push_back(42); // error: int is not an Animal
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Poly<Interface, N>: a value that holds any object satisfying a concept, stored
+// inline in N bytes. A std::vector<Poly<...>> is one contiguous array of mixed
+// types (Cow, Sheep, ...) with no heap allocation per element, where the classic
+// alternative is std::vector<std::unique_ptr<Base>> and a virtual base class.
+//
+// A concept cannot be passed as a template argument, so the concept is named by
+// an Interface type that says what Poly accepts and how to call it:
+//
+//     struct AnimalInterface
+//     {
+//         template <typename T> static constexpr bool accepts = Animal<T>;  // the concept
+//         struct VTable {void (*make_sound)(const void*);};                 // one entry per operation
+//         template <typename T> static constexpr VTable vtable{
+//             [](const void* self){static_cast<const T*>(self)->make_sound();}};
+//         template <typename Self> struct Methods                           // the members Poly gets
+//         {
+//             void make_sound() const
+//             {
+//                 const Self& self = static_cast<const Self&>(*this);
+//                 self.vtable().make_sound(self.object());
+//             }
+//         };
+//     };
+//
+// The types themselves need no common base class and no virtual functions.
+
+template <typename Interface, size_t N = 3 * sizeof(void*)>
+class Poly : public Interface::template Methods<Poly<Interface, N>> // CRTP: the interface adds the members
+{
+public:
+    template <typename T>
+        requires (!std::is_same_v<std::decay_t<T>, Poly>) && Interface::template accepts<std::decay_t<T>>
+    Poly(T&& value)
+    {
+        using U = std::decay_t<T>;
+        static_assert(sizeof(U) <= N, "type does not fit in this Poly: increase N");
+        static_assert(alignof(U) <= alignof(void*), "over-aligned types are not supported");
+        static_assert(std::is_nothrow_move_constructible_v<U>, "the type must be nothrow movable");
+        ::new (static_cast<void*>(storage)) U(std::forward<T>(value));
+        table = &tableFor<U>;
+    }
+
+    Poly(const Poly& other) : table{other.table} {table->copy(storage, other.storage);}
+    Poly(Poly&& other) noexcept : table{other.table} {table->move(storage, other.storage);}
+
+    Poly& operator=(const Poly& other)
+    {
+        if(this != &other)
+        {
+            Poly copy(other); // may throw; *this is untouched until it succeeded
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    Poly& operator=(Poly&& other) noexcept
+    {
+        if(this != &other)
+        {
+            table->destroy(storage);
+            table = other.table;
+            table->move(storage, other.storage);
+        }
+        return *this;
+    }
+
+    ~Poly() {table->destroy(storage);}
+
+    // For Interface::Methods: the operations of the stored type, and the object itself.
+    const typename Interface::VTable& vtable() const {return table->methods;}
+    const void* object() const {return storage;}
+    void* object() {return storage;}
+
+private:
+    // The interface's operations plus what every Poly needs to copy, move and destroy.
+    // One static table per stored type; a Poly holds a single pointer to it.
+    struct Table
+    {
+        void (*copy)(void* dst, const void* src);
+        void (*move)(void* dst, void* src) noexcept; // a move leaves `src` a valid moved-from object
+        void (*destroy)(void* self) noexcept;
+        typename Interface::VTable methods;
+    };
+
+    template <typename U>
+    static constexpr Table tableFor{
+        [](void* dst, const void* src){::new (dst) U(*static_cast<const U*>(src));},
+        [](void* dst, void* src) noexcept {::new (dst) U(std::move(*static_cast<U*>(src)));},
+        [](void* self) noexcept {static_cast<U*>(self)->~U();},
+        Interface::template vtable<U>,
+    };
+
+    const Table* table;
+    alignas(void*) unsigned char storage[N];
+};
+
+/*
+Why not std::vector<std::unique_ptr<Base>>?
+    Each element is a separate heap block: iterating means loading a pointer,
+    then following it to wherever the allocator put the object, then loading its
+    vptr. With Poly the object sits inside the element: iteration walks one array
+    and the only indirection left is the call through the type's table, which
+    lives in the program's read-only data and stays in cache.
+
+Why N?
+    Inline storage has to be sized up front, as for SmallFunction in item_35.
+    Types larger than N are rejected at compile time rather than silently put on
+    the heap; pick N for the largest type you store.
+
+Why copyable?
+    A Poly is a value, so a std::vector of them can be copied like any other
+    vector. The copy operation is part of every type's table, so the stored types
+    must be copy constructible.
+*/
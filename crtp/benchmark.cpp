@@ -0,0 +1,79 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <new>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "instancecounter.h"
+
+// Object creation throughput with a shared atomic counter (the obvious thread-safe
+// InstanceCounter) versus the sharded InstanceCounter, on 1, 2, 4, ... threads.
+// Each thread creates and destroys objects in batches of 128, so live counts move up
+// and down as in a real program.
+// usage: ./benchmark [max threads] [objects per thread]
+
+template <typename Derived>
+class AtomicCounter
+{
+public:
+    AtomicCounter() {count.fetch_add(1, std::memory_order_relaxed);}
+    AtomicCounter(const AtomicCounter&) {count.fetch_add(1, std::memory_order_relaxed);}
+    ~AtomicCounter() {count.fetch_sub(1, std::memory_order_relaxed);}
+    static size_t getCount() {return count.load(std::memory_order_relaxed);}
+private:
+    inline static std::atomic<size_t> count{0};
+};
+
+struct SharedTrade : AtomicCounter<SharedTrade> {double notional{1.0};};
+struct ShardedTrade : InstanceCounter<ShardedTrade> {double notional{1.0};};
+
+template <typename T>
+double mopsPerSecond(unsigned threads, size_t perThread)
+{
+    std::atomic<bool> go{false};
+    std::vector<std::thread> pool;
+    for(unsigned t = 0; t < threads; ++t)
+    {
+        pool.emplace_back([&]{
+            while(!go.load(std::memory_order_acquire)) {}
+            for(size_t i = 0; i < perThread; i += 128)
+            {
+                // placement-constructed, so the allocator does not dominate the measurement
+                alignas(T) unsigned char storage[128][sizeof(T)];
+                T* objects[128];
+                for(int k = 0; k < 128; ++k) objects[k] = new (storage[k]) T;
+                for(int k = 0; k < 128; ++k) objects[k]->~T();
+            }
+        });
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for(auto& th : pool) th.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return threads * perThread / seconds / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned maxThreads = argc > 1 ? std::atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    size_t perThread = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20'000'000;
+    std::printf("threads   shared atomic    sharded    (M objects/s)\n");
+    for(unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        double shared = mopsPerSecond<SharedTrade>(threads, perThread);
+        double sharded = mopsPerSecond<ShardedTrade>(threads, perThread);
+        std::printf("%7u   %13.1f   %8.1f\n", threads, shared, sharded);
+    }
+    std::printf("\n");
+    InstanceRegistry::dump(std::cout);
+}
+
+/*
+What to expect:
+    With one thread both are a few ns per object. With more threads the shared
+    atomic stops scaling, or gets slower, as its cache line moves between cores on
+    every construction. The sharded counter keeps scaling with the number of
+    cores. On a single-core machine the columns only show the single-thread cost.
+*/
@@ -0,0 +1,259 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+// InstanceCounter<Derived>: CRTP mix-in that counts the objects of each derived
+// type. Every thread counts into its own cache-line sized shard, which no other
+// thread writes, so creating objects on N threads costs no shared atomics and
+// scales with N. Reading the counts (stats(), getCount()) sums the shards.
+
+struct InstanceStats
+{
+    int64_t live{0};        // constructed minus destroyed
+    int64_t peak{0};        // highest `live` seen (see the note on accuracy below)
+    int64_t constructed{0}; // all constructions, including copies and moves
+    int64_t copied{0};
+    int64_t moved{0};
+};
+
+// One thread's counts for one type. Only the owning thread writes the counters, so
+// an increment is a plain load and store; they are atomics only so that stats() can
+// read them from another thread without a data race.
+struct alignas(64) InstanceCounterShard
+{
+    std::atomic<int64_t> created{0};
+    std::atomic<int64_t> destroyed{0};
+    std::atomic<int64_t> copied{0};
+    std::atomic<int64_t> moved{0};
+    int64_t pending{0}; // live delta not yet published to the shared total
+    bool owned{true};   // false once the thread exited; the shard is then reused
+};
+
+// Every instrumented type, so their counts can be dumped together.
+class InstanceRegistry
+{
+public:
+    using StatsFn = InstanceStats (*)();
+
+    static void add(std::string name, StatsFn stats)
+    {
+        std::lock_guard lock(instance().mutex);
+        instance().types.push_back({std::move(name), stats});
+    }
+
+    static void dump(std::ostream& os)
+    {
+        std::lock_guard lock(instance().mutex);
+        for(const Type& t : instance().types)
+        {
+            InstanceStats s = t.stats();
+            os << t.name << ": live " << s.live << ", peak " << s.peak << ", constructed " << s.constructed
+               << " (" << s.copied << " copies, " << s.moved << " moves)\n";
+        }
+    }
+
+private:
+    struct Type
+    {
+        std::string name;
+        StatsFn stats;
+    };
+
+    static InstanceRegistry& instance()
+    {
+        static InstanceRegistry registry;
+        return registry;
+    }
+
+    std::mutex mutex;
+    std::vector<Type> types;
+};
+
+template <typename Derived>
+class InstanceCounter
+{
+public:
+    InstanceCounter() {created();}
+    InstanceCounter(const InstanceCounter&) {created(&InstanceCounterShard::copied);}
+    InstanceCounter(InstanceCounter&&) noexcept {created(&InstanceCounterShard::moved);} // the source still exists
+    InstanceCounter& operator=(const InstanceCounter&) = default; // assignment creates no object
+    InstanceCounter& operator=(InstanceCounter&&) = default;
+    ~InstanceCounter() {destroyed();}
+
+    static size_t getCount()
+    {
+        return static_cast<size_t>(stats().live);
+    }
+
+    static InstanceStats stats()
+    {
+        State& st = state();
+        std::lock_guard lock(st.mutex);
+        InstanceStats s;
+        for(const auto& shard : st.shards)
+        {
+            s.constructed += shard->created.load(std::memory_order_relaxed);
+            s.live -= shard->destroyed.load(std::memory_order_relaxed);
+            s.copied += shard->copied.load(std::memory_order_relaxed);
+            s.moved += shard->moved.load(std::memory_order_relaxed);
+        }
+        s.live += s.constructed;
+        s.peak = std::max(st.peak.load(std::memory_order_relaxed), s.live);
+        return s;
+    }
+
+private:
+    // Each thread publishes its live delta to the shared total every Batch objects,
+    // so the shared cache line is touched once per Batch constructions, not each one.
+    static constexpr int64_t Batch = 64;
+
+    struct State
+    {
+        std::mutex mutex; // guards `shards`; taken when a thread starts or ends, and by stats()
+        std::vector<std::unique_ptr<InstanceCounterShard>> shards;
+        std::atomic<int64_t> live{0};
+        std::atomic<int64_t> peak{0};
+    };
+
+    // Releases the thread's shard when the thread exits. Objects destroyed after
+    // that (thread_local or static objects of this thread) count into a shared shard.
+    struct LocalShard
+    {
+        InstanceCounterShard* shard{nullptr};
+        bool exited{false};
+        ~LocalShard()
+        {
+            if(shard) release(shard);
+            shard = nullptr;
+            exited = true;
+        }
+    };
+
+    static State& state()
+    {
+        static State* st = []{
+            InstanceRegistry::add(typeName(), &InstanceCounter::stats);
+            return new State; // never destroyed: objects may outlive static destruction
+        }();
+        return *st;
+    }
+
+    static void bump(std::atomic<int64_t>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    static void created(std::atomic<int64_t> InstanceCounterShard::*kind = nullptr)
+    {
+        InstanceCounterShard* s = shard();
+        if(!s) return lateEvent(1, kind);
+        bump(s->created);
+        if(kind) bump(s->*kind);
+        if(++s->pending >= Batch) publish(*s);
+    }
+
+    static void destroyed()
+    {
+        InstanceCounterShard* s = shard();
+        if(!s) return lateEvent(-1, nullptr);
+        bump(s->destroyed);
+        if(--s->pending <= -Batch) publish(*s);
+    }
+
+    static InstanceCounterShard* shard()
+    {
+        LocalShard& l = local;
+        if(l.shard) return l.shard;
+        if(l.exited) return nullptr;
+        return l.shard = acquire();
+    }
+
+    static void publish(InstanceCounterShard& s)
+    {
+        State& st = state();
+        int64_t live = st.live.fetch_add(s.pending, std::memory_order_relaxed) + s.pending;
+        s.pending = 0;
+        int64_t peak = st.peak.load(std::memory_order_relaxed);
+        while(live > peak && !st.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    [[gnu::noinline]] static InstanceCounterShard* acquire()
+    {
+        State& st = state();
+        std::lock_guard lock(st.mutex);
+        for(const auto& s : st.shards)
+        {
+            if(!s->owned)
+            {
+                s->owned = true; // counts of the exited thread stay in it, which is what we want
+                return s.get();
+            }
+        }
+        st.shards.push_back(std::make_unique<InstanceCounterShard>());
+        return st.shards.back().get();
+    }
+
+    static void release(InstanceCounterShard* s)
+    {
+        publish(*s);
+        State& st = state();
+        std::lock_guard lock(st.mutex);
+        s->owned = false;
+    }
+
+    // Rare: a thread that already released its shard. Uses a dedicated shard with
+    // real read-modify-writes, since several exiting threads may share it.
+    [[gnu::noinline]] static void lateEvent(int64_t delta, std::atomic<int64_t> InstanceCounterShard::*kind)
+    {
+        static InstanceCounterShard* late = []{
+            State& st = state();
+            std::lock_guard lock(st.mutex);
+            st.shards.push_back(std::make_unique<InstanceCounterShard>());
+            return st.shards.back().get(); // stays `owned`, so no thread ever claims it
+        }();
+        (delta > 0 ? late->created : late->destroyed).fetch_add(1, std::memory_order_relaxed);
+        if(kind) (late->*kind).fetch_add(1, std::memory_order_relaxed);
+        state().live.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    static std::string typeName()
+    {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(typeid(Derived).name(), nullptr, nullptr, &status);
+        std::string name = status == 0 ? demangled : typeid(Derived).name();
+        std::free(demangled);
+        return name;
+    }
+
+    inline static thread_local LocalShard local;
+};
+
+/*
+Why not one std::atomic<size_t> per type?
+    It would be correct, but every construction and destruction on every thread
+    would do a locked read-modify-write on the same cache line. At high creation
+    rates the line bounces between cores and the counter becomes the bottleneck:
+    adding threads makes it slower, not faster. With a shard per thread there is
+    nothing to bounce; the shared total is touched once per Batch objects.
+
+Accuracy:
+    live, constructed, copied and moved are exact once the threads involved are
+    quiescent (a reading taken while other threads create objects is a snapshot
+    of a moving target, as with any counter). peak is tracked from the published
+    totals, so it can miss a short spike of fewer than Batch objects per thread.
+
+Why count the move constructor?
+    A moved-from object is still alive and will be destroyed, so a move creates
+    one more instance just like a copy does. The counts balance only if both are
+    counted; they are also reported separately, since moves are cheap and copies
+    may not be.
+*/
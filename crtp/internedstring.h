@@ -0,0 +1,187 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// InternedString: an immutable string handle backed by a global intern table.
+// Equal strings share one buffer, so
+//   * an InternedString is a single pointer (8 bytes, trivially copyable),
+//   * equality is a pointer comparison,
+//   * the hash is computed once, when the string is interned.
+// Interning costs one hash-table lookup, so it pays off for identifiers that are
+// created once and then stored, copied and compared many times ("UST10Y", "AMZN",
+// school names, ...). Interned buffers live until the end of the program.
+
+class InternTable
+{
+public:
+    // The shared, immutable representation: hash, size and the characters (NUL-terminated).
+    struct Entry
+    {
+        size_t hash;
+        size_t size;
+        char data[1];
+
+        std::string_view view() const {return {data, size};}
+    };
+
+    static const Entry* intern(std::string_view text)
+    {
+        size_t h = std::hash<std::string_view>{}(text);
+        Shard& shard = instance().shards[h % NumShards];
+        Key key{text, h};
+        {
+            std::shared_lock lock(shard.mutex); // readers proceed in parallel
+            auto it = shard.entries.find(key);
+            if(it != shard.entries.end()) return it->second;
+        }
+        std::unique_lock lock(shard.mutex);
+        auto it = shard.entries.find(key); // someone may have inserted it meanwhile
+        if(it != shard.entries.end()) return it->second;
+        const Entry* e = shard.make(text, h);
+        shard.entries.emplace(Key{e->view(), h}, e);
+        return e;
+    }
+
+    static const Entry* empty()
+    {
+        static const Entry* e = intern({});
+        return e;
+    }
+
+    struct Stats
+    {
+        size_t strings{0};
+        size_t bytes{0}; // characters plus entry headers, excluding the hash tables
+    };
+
+    static Stats stats()
+    {
+        Stats s;
+        for(Shard& shard : instance().shards)
+        {
+            std::shared_lock lock(shard.mutex);
+            s.strings += shard.entries.size();
+            s.bytes += shard.used;
+        }
+        return s;
+    }
+
+private:
+    static constexpr size_t NumShards = 64; // independent locks, so threads rarely meet
+    static constexpr size_t ChunkSize = 64 * 1024;
+
+    struct Key
+    {
+        std::string_view text;
+        size_t hash;
+        bool operator==(const Key& other) const {return hash == other.hash && text == other.text;}
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& k) const {return k.hash;} // already computed, never rehash
+    };
+
+    struct Shard
+    {
+        std::shared_mutex mutex;
+        std::unordered_map<Key, const Entry*, KeyHash> entries;
+        std::vector<std::unique_ptr<char[]>> chunks; // entries are bump-allocated, no per-string malloc
+        size_t chunkUsed{ChunkSize};
+        size_t used{0};
+
+        const Entry* make(std::string_view text, size_t h)
+        {
+            size_t bytes = (offsetof(Entry, data) + text.size() + 1 + alignof(Entry) - 1) & ~(alignof(Entry) - 1);
+            char* p;
+            if(bytes > ChunkSize / 4) // big strings get their own block
+            {
+                chunks.emplace_back(new char[bytes]);
+                p = chunks.back().get();
+            }
+            else
+            {
+                if(chunkUsed + bytes > ChunkSize)
+                {
+                    chunks.emplace_back(new char[ChunkSize]);
+                    chunkUsed = 0;
+                }
+                p = chunks.back().get() + chunkUsed;
+                chunkUsed += bytes;
+            }
+            used += bytes;
+            Entry* e = reinterpret_cast<Entry*>(p);
+            e->hash = h;
+            e->size = text.size();
+            if(!text.empty()) std::memcpy(e->data, text.data(), text.size());
+            e->data[text.size()] = '\0';
+            return e;
+        }
+    };
+
+    // Function-local static: safe to use from other static initializers.
+    static InternTable& instance()
+    {
+        static InternTable table;
+        return table;
+    }
+
+    std::array<Shard, NumShards> shards;
+};
+
+class InternedString
+{
+public:
+    InternedString() : entry{InternTable::empty()} {}
+    InternedString(std::string_view text) : entry{InternTable::intern(text)} {}
+    InternedString(const char* text) : InternedString{std::string_view{text}} {}
+    InternedString(const std::string& text) : InternedString{std::string_view{text}} {}
+
+    std::string_view view() const {return entry->view();}
+    const char* c_str() const {return entry->data;}
+    size_t size() const {return entry->size;}
+    bool empty() const {return entry->size == 0;}
+    size_t hash() const {return entry->hash;}
+
+    // One buffer per distinct string, so comparing pointers compares contents.
+    friend bool operator==(InternedString a, InternedString b) {return a.entry == b.entry;}
+
+    // Ordering is by content (pointer order would differ from run to run).
+    friend bool operator<(InternedString a, InternedString b) {return a.entry != b.entry && a.view() < b.view();}
+
+    friend std::ostream& operator<<(std::ostream& os, InternedString s) {return os << s.view();}
+
+private:
+    const InternTable::Entry* entry;
+};
+
+template <>
+struct std::hash<InternedString>
+{
+    size_t operator()(InternedString s) const noexcept {return s.hash();}
+};
+
+/*
+Why shard the table?
+    Interning from many threads at once would serialize on a single mutex. With 64
+    shards picked by hash, two threads only contend when they intern strings that
+    land in the same shard at the same moment. Lookups of already interned strings,
+    by far the common case, take only a shared (reader) lock.
+
+Memory:
+    A std::string of "UST10Y" is 32 bytes, and a heap block on top once the text
+    outgrows the SSO buffer, for every copy. An InternedString is 8 bytes per copy
+    plus one shared entry (hash + size + text, about 24-32 bytes) per distinct string.
+    With millions of copies of a few thousand identifiers the saving is about 4x on
+    the handles alone, and all the duplicate buffers disappear.
+*/
@@ -1,68 +1,31 @@
 #include <iostream>
 #include <string>
+#include <vector>
+#include "instancecounter.h" // InstanceCounter<Derived>, one sharded counter per type
+#include "internedstring.h"
+#include "pipeline.h"
 
-template <typename Derived>
-class InstanceCounter
-{
-public:
-    InstanceCounter() {++count;}
-    InstanceCounter(const InstanceCounter& other) {++count;}
-    ~InstanceCounter(){--count;}
-    static size_t getCount(){
-        return count;
-    }
-
-private:
-    inline static size_t count{0};
-};
-
-// template <typename Derived>
-// size_t InstanceCounter<Derived>::count{0};
-
+// Instrument names repeat a lot (every trade/position on "UST10Y" carries it),
+// so they are interned: one shared buffer per name, 8 bytes per instrument.
 class Bond : public InstanceCounter<Bond> 
 {
 public:
-    Bond(std::string name_) : name{name_}{}
+    Bond(InternedString name_) : name{name_}{}
+    InternedString getName() const {return name;}
 private:
-    std::string name;
+    InternedString name;
 };
 
 class Equity : public InstanceCounter<Equity> 
 {
 public:
-    Equity(std::string name_) : name{name_}{}
+    Equity(InternedString name_) : name{name_}{}
+    InternedString getName() const {return name;}
 private:
-    std::string name;
+    InternedString name;
 };
 
-// Second example 
-template <typename Derived>
-class Base
-{
-public:
-
-    void compute(double& x)
-    {
-        static_cast<Derived*>(this)->impl(x);
-    }
-protected:
-    Base() = default; 
-    // constructor is protected to prohibit the creation of Base objects, so that it is accessible to derived classes.
-};
-
-class addOne : public Base<addOne>
-{
-public:
-    addOne(){};
-    void impl(double& x){x += 1.0;}
-};
-
-class multTwo : public Base<multTwo>
-{
-public:
-    multTwo(){};
-    void impl(double& x){x *= 2.0;}
-};
+// Second example: Base<Derived>, addOne, multTwo and Pipeline are in pipeline.h
 
 
 // Third example
@@ -113,6 +76,18 @@ int main()
     std::cout << "Bond count: " << Bond::getCount() << "\n";
     std::cout << "Equity count: " << Equity::getCount() << "\n";
 
+    // Interned names: equal names share one buffer, so == is a pointer comparison.
+    std::vector<Bond> book;
+    for(int i = 0; i < 100000; ++i) book.emplace_back(i % 2 ? "UST10Y" : "FR2Y");
+    std::cout << "Same name, same buffer: " << (book[1].getName().c_str() == b1.getName().c_str()) << "\n";
+    std::cout << "b1 == book[1]: " << (book[1].getName() == b1.getName())
+              << ", b1 == b2: " << (b1.getName() == b2.getName()) << "\n";
+    InternTable::Stats stats = InternTable::stats();
+    std::cout << book.size() << " bond names stored in " << stats.strings << " interned strings ("
+              << stats.bytes << " bytes of text and headers)\n";
+    // The vector moved the bonds each time it grew; moves create instances too.
+    InstanceRegistry::dump(std::cout);
+
     // second example
     double x = 4.0;
     std::cout << "x = " << x  << "\n";
@@ -122,6 +97,13 @@ int main()
     std::cout << "x = " << x  << "\n";
     multTwoCalc.compute(x); // calls the compute implementation defined in the subclass multTwo
     std::cout << "x = " << x  << "\n";
+    // Both steps fused into one: a single loop over the whole array.
+    std::vector<double> xs{1.0, 2.0, 3.0, 4.0};
+    Pipeline<addOne, multTwo> addThenMult;
+    addThenMult.compute(xs);
+    std::cout << "(x + 1) * 2 over {1, 2, 3, 4}:";
+    for(double v : xs) std::cout << " " << v;
+    std::cout << "\n";
 
     // third example
     Cow betty;
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <span>
+#include <tuple>
+
+// CRTP compute steps, and Pipeline<Steps...> which fuses several steps into one.
+//
+// A step is a class deriving from Base<Step> with `void impl(double&) const`.
+// Base<Step>::compute resolves to Step::impl at compile time, so a step can be
+// inlined into any loop that calls it.
+
+template <typename Derived>
+class Base
+{
+public:
+
+    void compute(double& x) const
+    {
+        static_cast<const Derived*>(this)->impl(x);
+    }
+
+    // One pass over the array, applying only this step.
+    void compute(std::span<double> xs) const
+    {
+        for(double& x : xs) compute(x);
+    }
+protected:
+    Base() = default;
+    // constructor is protected to prohibit the creation of Base objects, so that it is accessible to derived classes.
+};
+
+class addOne : public Base<addOne>
+{
+public:
+    addOne(){};
+    void impl(double& x) const {x += 1.0;}
+};
+
+class multTwo : public Base<multTwo>
+{
+public:
+    multTwo(){};
+    void impl(double& x) const {x *= 2.0;}
+};
+
+// Pipeline<addOne, multTwo> is itself a step: impl applies every stage, in order,
+// to one value, and the inherited compute(span) runs all of them in a single loop.
+// Each element is loaded once, goes through all stages in registers, and is
+// stored once. The loop body is branch-free straight-line code, which the
+// compiler can vectorise. Pipelines nest: Pipeline<Pipeline<addOne, multTwo>, addOne>.
+template <typename... Steps>
+class Pipeline : public Base<Pipeline<Steps...>>
+{
+public:
+    Pipeline() = default;
+    explicit Pipeline(Steps... steps_) : steps{steps_...} {}
+
+    void impl(double& x) const
+    {
+        std::apply([&x](const Steps&... step){(step.compute(x), ...);}, steps); // fold: stage 1, stage 2, ...
+    }
+
+private:
+    std::tuple<Steps...> steps;
+};
+
+/*
+Why fuse?
+    Running addOne over a large array and then multTwo over it reads and writes
+    every element twice. Once the array is larger than the caches, both passes
+    are limited by memory bandwidth, so the second pass costs as much as the
+    first. The fused loop moves each element through memory once, however many
+    stages there are, and the arithmetic is almost free in comparison.
+
+Why templates and not a std::vector<std::function<void(double&)>>?
+    A runtime list of stages is a call per stage per element; nothing can be
+    inlined, and the loop cannot be vectorised. Here the list of stages is part of
+    the type, so the whole pipeline compiles to one loop of adds and multiplies.
+*/
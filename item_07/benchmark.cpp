@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+#include "payoff.h"
+
+// Per-spot payoff evaluation (operator(), one virtual call per spot) against the
+// batch interface (evaluate(), one virtual call per batch), for a call and a put
+// with vectorised batch loops, and for a user-defined payoff that only has
+// operator() and so gets the default batch loop.
+// Usage: ./benchmark [spots per batch, default 4096]
+
+using Clock = std::chrono::steady_clock;
+
+// Defined here, as a user would: no doEvaluate override.
+class PayoffDigital : public Payoff
+{
+public:
+    PayoffDigital(double Strike_) : Strike{Strike_} {}
+    virtual double operator()(double Spot) const override {return Spot > Strike ? 1.0 : 0.0;}
+    virtual Payoff* clone() const override {return new PayoffDigital(*this);}
+
+private:
+    double Strike;
+};
+
+// noinline: the payoff's dynamic type must not be visible to the loop, as in an
+// engine that receives a Payoff& from its caller.
+[[gnu::noinline]] void perSpot(const Payoff& payoff, const std::vector<double>& spots, std::vector<double>& out)
+{
+    for(size_t i = 0; i < spots.size(); ++i) out[i] = payoff(spots[i]);
+}
+
+[[gnu::noinline]] void batch(const Payoff& payoff, const std::vector<double>& spots, std::vector<double>& out)
+{
+    payoff.evaluate(spots, out);
+}
+
+template <typename F>
+double nsPerSpot(size_t n, F&& f)
+{
+    size_t reps = std::max<size_t>(1, 100000000 / n);
+    auto t0 = Clock::now();
+    for(size_t r = 0; r < reps; ++r)
+    {
+        f();
+        asm volatile("" ::: "memory");
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / (double(reps) * n);
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4096;
+
+    // Terminal spots of a geometric Brownian motion: S0 = 100, 20% volatility, 1 year.
+    std::mt19937_64 rng(42);
+    std::normal_distribution<double> z;
+    std::vector<double> spots(n), a(n), b(n);
+    for(double& s : spots) s = 100.0 * std::exp(-0.02 + 0.2 * z(rng));
+
+    std::unique_ptr<Payoff> payoffs[] = {std::make_unique<PayoffCall>(100.0), std::make_unique<PayoffPut>(100.0),
+                                         std::make_unique<PayoffDigital>(100.0)};
+    const char* names[] = {"call", "put", "digital (default batch)"};
+
+    std::printf("%zu spots per batch, ns per spot\n", n);
+    for(size_t p = 0; p < 3; ++p)
+    {
+        double tSpot = nsPerSpot(n, [&] {perSpot(*payoffs[p], spots, a);});
+        double tBatch = nsPerSpot(n, [&] {batch(*payoffs[p], spots, b);});
+        std::printf("  %-24s per spot %5.2f  batch %5.2f  (%4.1fx, results %s)\n", names[p], tSpot, tBatch,
+                    tSpot / tBatch, a == b ? "identical" : "DIFFER");
+    }
+}
+
+/*
+Reading the numbers:
+    Per spot, each evaluation is an indirect call; it is well predicted (the
+    same target every time), so the cost is the call itself plus a loop the
+    compiler cannot vectorise. The call and put batches run the max(x - K, 0)
+    loop several spots per instruction; for batches much larger than the caches
+    the gain shrinks to what memory bandwidth allows. The digital payoff shows
+    the default doEvaluate: the same loop of virtual calls moved inside the
+    class, so no faster (the runs vary by +-20%). Its time is dominated by the
+    Spot > Strike branch, which random spots mispredict half the time; the
+    predictor partly learns a small batch that is evaluated over and over.
+    The results are identical bit for bit, as the batch kernels do the same
+    operations per spot as operator().
+*/
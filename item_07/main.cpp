@@ -1,69 +1,7 @@
 #include <iostream>
-#include <algorithm>
-
-// Payoff is a polymorphic base class because it declares virtual functions
-// (operator() and clone) and is intended to be used via base class pointers.
-// According to Item 7, such classes MUST have a virtual destructor to ensure
-// derived destructors are called correctly when deleting via a base pointer.
-
-class Payoff
-{
-public:
-    Payoff() = default; // allows derived classes to construct Payoff
-    virtual double operator()(double Spot) const = 0;
-    // Pure virtual function makes this an abstract class — typical for polymorphic use.
-    virtual Payoff* clone() const = 0;
-    // clone is also virtual — used for polymorphic copying.
-    
-    virtual ~Payoff() = 0;     
-    // Virtual destructor is essential! Without it, deleting a derived object
-    // (e.g., PayoffCall or PayoffPut) through a Payoff* leads to undefined behavior.
-private:
-};
-
-Payoff::~Payoff() {} // virtual destructor needs to be declared
-
-
-
-
-class PayoffCall : public Payoff
-{
-public:
-    PayoffCall(double Strike_) : Strike{Strike_} {}
-    virtual inline double operator()(double Spot) const override
-    {
-        return std::max(Spot-Strike,0.0);
-    }
-    virtual Payoff* clone() const override
-    {
-        return new PayoffCall(*this);
-    }
-    virtual ~PayoffCall() override {};
-    // Virtual destructor is needed to be declared, as the base class has a pure virtual destructor,
-    // in a case like this, one could define the base destructor and not override it.
-
-private:
-    double Strike;
-};
-
-class PayoffPut : public Payoff
-{
-public:
-    PayoffPut(double Strike_) : Strike{Strike_} {}
-    virtual inline double operator()(double Spot) const override
-    {
-        return std::max(Strike-Spot,0.0);
-    }
-    virtual Payoff* clone() const override
-    {
-        return new PayoffPut(*this);
-    }
-    virtual ~PayoffPut() override {};
-
-private:
-    double Strike;
-};
-
+#include <vector>
+#include "payoff.h"
+#include "valuepayoff.h"
 
 int main()
 {
@@ -77,6 +15,25 @@ int main()
     std::cout << "Payoff Call at Spot = 90: " << ppc->operator()(Spot) << "\n";
     std::cout << "Payoff Put at Spot = 90: " << ppp->operator()(Spot) << "\n";
 
+    // A batch of spots: one virtual call evaluates them all.
+    std::vector<double> spots{80, 90, 100, 110, 120}, values(spots.size());
+    ppc->evaluate(spots, values);
+    std::cout << "Payoff Call at Spots 80..120:";
+    for(double v : values) std::cout << " " << v;
+    std::cout << "\n";
+
+    // Payoffs as values: copied without clone() and without a heap allocation each.
+    std::vector<ValuePayoffs::VariantPayoff> book{ValuePayoffs::Straddle{100.0}, PayoffPut(100.0)};
+    std::vector<ValuePayoffs::VariantPayoff> bookCopy = book;
+    std::cout << "Straddle and Put at Spot = 90: " << bookCopy[0](90.0) << ", " << bookCopy[1](90.0) << "\n";
+
+    // Too large for the inline buffer: kept on the heap, and still a value.
+    struct Ladder {double Strikes[8]; double operator()(double Spot) const
+        {double v = 0; for(double k : Strikes) v += std::max(Spot - k, 0.0); return v;}};
+    ValuePayoffs::VariantPayoff ladder = Ladder{{80, 85, 90, 95, 100, 105, 110, 115}};
+    ValuePayoffs::VariantPayoff ladderCopy = ladder;
+    std::cout << "Call ladder 80..115 at Spot = 100: " << ladderCopy(100.0) << "\n";
+
     // Safe deletion via base pointer due to virtual destructor
     delete ppc;
     delete ppp;
@@ -0,0 +1,106 @@
+#pragma once
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+#include "../item_48/simdkernels.h"
+
+// Payoff is a polymorphic base class because it declares virtual functions
+// (operator() and clone) and is intended to be used via base class pointers.
+// According to Item 7, such classes MUST have a virtual destructor to ensure
+// derived destructors are called correctly when deleting via a base pointer.
+
+class Payoff
+{
+public:
+    Payoff() = default; // allows derived classes to construct Payoff
+    virtual double operator()(double Spot) const = 0;
+    // Pure virtual function makes this an abstract class — typical for polymorphic use.
+    virtual Payoff* clone() const = 0;
+    // clone is also virtual — used for polymorphic copying.
+
+    // Batch form: out[i] = (*this)(spots[i]), one virtual call for the whole batch.
+    // Non-virtual interface (Item 35): the size check is done once, here.
+    void evaluate(std::span<const double> spots, std::span<double> out) const
+    {
+        if(spots.size() != out.size()) throw std::invalid_argument("Payoff::evaluate: spots and out differ in size");
+        doEvaluate(spots, out);
+    }
+
+    virtual ~Payoff() = 0;
+    // Virtual destructor is essential! Without it, deleting a derived object
+    // (e.g., PayoffCall or PayoffPut) through a Payoff* leads to undefined behavior.
+private:
+    // Fallback for payoffs that only define operator(): a loop over it, still one
+    // virtual call per spot. Override it with a loop the compiler can vectorise.
+    virtual void doEvaluate(std::span<const double> spots, std::span<double> out) const
+    {
+        for(size_t i = 0; i < spots.size(); ++i) out[i] = (*this)(spots[i]);
+    }
+};
+
+inline Payoff::~Payoff() {} // virtual destructor needs to be declared
+
+
+
+
+class PayoffCall : public Payoff
+{
+public:
+    PayoffCall(double Strike_) : Strike{Strike_} {}
+    virtual inline double operator()(double Spot) const override
+    {
+        return std::max(Spot-Strike,0.0);
+    }
+    virtual Payoff* clone() const override
+    {
+        return new PayoffCall(*this);
+    }
+    virtual ~PayoffCall() override {};
+    // Virtual destructor is needed to be declared, as the base class has a pure virtual destructor,
+    // in a case like this, one could define the base destructor and not override it.
+
+private:
+    // max(1 * Spot - Strike, 0): the same arithmetic as operator(), so the same bits.
+    virtual void doEvaluate(std::span<const double> spots, std::span<double> out) const override
+    {
+        simd::ramp(1.0, -Strike, spots.data(), out.data(), spots.size());
+    }
+
+    double Strike;
+};
+
+class PayoffPut : public Payoff
+{
+public:
+    PayoffPut(double Strike_) : Strike{Strike_} {}
+    virtual inline double operator()(double Spot) const override
+    {
+        return std::max(Strike-Spot,0.0);
+    }
+    virtual Payoff* clone() const override
+    {
+        return new PayoffPut(*this);
+    }
+    virtual ~PayoffPut() override {};
+
+private:
+    virtual void doEvaluate(std::span<const double> spots, std::span<double> out) const override
+    {
+        simd::ramp(-1.0, Strike, spots.data(), out.data(), spots.size());
+    }
+
+    double Strike;
+};
+
+/*
+Why a batch interface?
+    Pricing evaluates the payoff at millions of simulated spots. Through
+    operator() that is one indirect call per spot, and the compiler cannot
+    vectorise across calls it cannot see into. evaluate() moves the loop inside
+    the virtual function: the dispatch is paid once per batch, and the loop body
+    (a subtraction and a max for a call) runs several spots per instruction.
+Why keep operator()?
+    A payoff written by a user only has to define operator(); the default
+    doEvaluate loops over it. Overriding doEvaluate is an optimisation, not a
+    requirement.
+*/
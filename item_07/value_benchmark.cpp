@@ -0,0 +1,158 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+#include "valuepayoff.h"
+
+// A book of 1024 payoffs (call, put, digital, straddle) held three ways:
+//   virtual:   std::vector<std::unique_ptr<Payoff>>, copied with clone()
+//   variant:   std::vector<VariantPayoff> of Call, Put, Digital, Straddle
+//   fallback:  std::vector<VariantPayoff> built from the Payoff subclasses, so
+//              every element is the type-erased AnyPayoff alternative
+// Dispatch: evaluating every payoff at a spot, ns per payoff, with all payoffs
+// of one kind and with the four kinds shuffled. Copy: copying the whole book,
+// ns and heap allocations per payoff.
+
+using Clock = std::chrono::steady_clock;
+using namespace ValuePayoffs;
+
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    if(void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete(void* p, size_t) noexcept {std::free(p);}
+
+class PayoffDigital : public Payoff
+{
+public:
+    PayoffDigital(double Strike_) : Strike{Strike_} {}
+    virtual double operator()(double Spot) const override {return Spot > Strike ? 1.0 : 0.0;}
+    virtual Payoff* clone() const override {return new PayoffDigital(*this);}
+private:
+    double Strike;
+};
+
+class PayoffStraddle : public Payoff
+{
+public:
+    PayoffStraddle(double Strike_) : Strike{Strike_} {}
+    virtual double operator()(double Spot) const override {return std::abs(Spot - Strike);}
+    virtual Payoff* clone() const override {return new PayoffStraddle(*this);}
+private:
+    double Strike;
+};
+
+constexpr size_t BookSize = 1024;
+constexpr size_t Reps = 20000;
+
+struct Book
+{
+    std::vector<std::unique_ptr<Payoff>> virtuals;
+    std::vector<VariantPayoff> variants;
+    std::vector<VariantPayoff> fallbacks;
+};
+
+Book makeBook(bool shuffled)
+{
+    std::mt19937 rng(11);
+    Book book;
+    for(size_t i = 0; i < BookSize; ++i)
+    {
+        double strike = 80.0 + i % 41;
+        switch(shuffled ? rng() % 4 : 0)
+        {
+            case 0: book.virtuals.push_back(std::make_unique<PayoffCall>(strike));
+                    book.variants.push_back(Call{strike}); book.fallbacks.push_back(PayoffCall(strike)); break;
+            case 1: book.virtuals.push_back(std::make_unique<PayoffPut>(strike));
+                    book.variants.push_back(Put{strike}); book.fallbacks.push_back(PayoffPut(strike)); break;
+            case 2: book.virtuals.push_back(std::make_unique<PayoffDigital>(strike));
+                    book.variants.push_back(Digital{strike}); book.fallbacks.push_back(PayoffDigital(strike)); break;
+            default: book.virtuals.push_back(std::make_unique<PayoffStraddle>(strike));
+                     book.variants.push_back(Straddle{strike}); book.fallbacks.push_back(PayoffStraddle(strike));
+        }
+    }
+    return book;
+}
+
+template <typename F>
+double nsPerPayoff(size_t reps, F&& f)
+{
+    auto t0 = Clock::now();
+    for(size_t r = 0; r < reps; ++r)
+    {
+        f(r);
+        asm volatile("" ::: "memory");
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / (double(reps) * BookSize);
+}
+
+[[gnu::noinline]] double value(const std::vector<std::unique_ptr<Payoff>>& book, double spot)
+{
+    double total = 0;
+    for(const auto& p : book) total += (*p)(spot);
+    return total;
+}
+
+[[gnu::noinline]] double value(const std::vector<VariantPayoff>& book, double spot)
+{
+    double total = 0;
+    for(const VariantPayoff& p : book) total += p(spot);
+    return total;
+}
+
+int main()
+{
+    for(bool shuffled : {false, true})
+    {
+        Book book = makeBook(shuffled);
+        std::printf("%s\n", shuffled ? "four kinds, shuffled" : "all calls");
+        double totals[3] = {};
+        auto spot = [](size_t r) {return 90.0 + double(r % 32);};
+        double tVirtual = nsPerPayoff(Reps, [&](size_t r) {totals[0] += value(book.virtuals, spot(r));});
+        double tVariant = nsPerPayoff(Reps, [&](size_t r) {totals[1] += value(book.variants, spot(r));});
+        double tFallback = nsPerPayoff(Reps, [&](size_t r) {totals[2] += value(book.fallbacks, spot(r));});
+        std::printf("  dispatch   virtual %5.2f ns  variant %5.2f ns  fallback %5.2f ns  (totals %s)\n",
+                    tVirtual, tVariant, tFallback,
+                    totals[0] == totals[1] && totals[1] == totals[2] ? "equal" : "DIFFER");
+
+        size_t before = allocations;
+        double cVirtual = nsPerPayoff(Reps / 10, [&](size_t) {
+            std::vector<std::unique_ptr<Payoff>> copy;
+            copy.reserve(book.virtuals.size());
+            for(const auto& p : book.virtuals) copy.emplace_back(p->clone());
+        });
+        double aVirtual = double(allocations - before) / (Reps / 10) / BookSize;
+        before = allocations;
+        double cVariant = nsPerPayoff(Reps / 10, [&](size_t) {std::vector<VariantPayoff> copy = book.variants;});
+        double aVariant = double(allocations - before) / (Reps / 10) / BookSize;
+        before = allocations;
+        double cFallback = nsPerPayoff(Reps / 10, [&](size_t) {std::vector<VariantPayoff> copy = book.fallbacks;});
+        double aFallback = double(allocations - before) / (Reps / 10) / BookSize;
+        std::printf("  copy       virtual %5.2f ns  variant %5.2f ns  fallback %5.2f ns  "
+                    "(allocations per payoff %.3f / %.3f / %.3f)\n",
+                    cVirtual, cVariant, cFallback, aVirtual, aVariant, aFallback);
+    }
+}
+
+/*
+Reading the numbers:
+    std::visit compiles to a jump table into the inlined, branch-free bodies of
+    the four payoffs; the virtual version adds a call and a return per payoff
+    and cannot keep values in registers across it. Shuffling costs the virtual
+    book much more than the variant one. The same book is evaluated over and
+    over, so the indirect branch predictor may learn part of the sequence; a
+    book that changed between evaluations would mispredict more, in both.
+    Copying: clone() is one heap allocation per payoff (plus the vector), the
+    variant book is one allocation for the whole vector and a copy of each
+    element. The fallback copies inline too, but through the stored type's copy
+    function: an indirect call per element, slower when the types are mixed.
+    The totals are equal: all three compute the same payoffs in the same order.
+*/
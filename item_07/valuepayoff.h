@@ -0,0 +1,204 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "payoff.h"
+#include "../concepts/poly.h"
+#include "../item_48/simdkernels.h"
+
+// Payoffs as values. A Payoff* has to be cloned (a heap allocation) to be copied
+// and is called through a vtable. VariantPayoff holds the common payoffs directly,
+// in a std::variant: copying is copying a few bytes, and a call is a switch on
+// the alternative (std::visit) to code that is inlined.
+//
+//     ValuePayoffs::VariantPayoff p = ValuePayoffs::Call{100.0};
+//     double v = p(120.0);                    // 20
+//     std::vector<VariantPayoff> book{Call{100.0}, Put{90.0}, Straddle{100.0}};
+//     auto copy = book;                       // one allocation, for the vector
+//
+// Any other type with `double operator()(double) const`, including the existing
+// Payoff subclasses (PayoffCall, or one a user wrote), goes into the last
+// alternative, AnyPayoff: type-erased but stored inline (Poly, from concepts/),
+// so it is still copied without an allocation. A type larger than AnyPayoffBytes
+// is kept on the heap instead (HeapPayoff), and copying it allocates, as clone()
+// would.
+
+namespace ValuePayoffs
+{
+
+struct Call
+{
+    double Strike;
+    double operator()(double Spot) const {return std::max(Spot - Strike, 0.0);}
+    void evaluate(std::span<const double> spots, std::span<double> out) const
+    {
+        simd::ramp(1.0, -Strike, spots.data(), out.data(), spots.size());
+    }
+};
+
+struct Put
+{
+    double Strike;
+    double operator()(double Spot) const {return std::max(Strike - Spot, 0.0);}
+    void evaluate(std::span<const double> spots, std::span<double> out) const
+    {
+        simd::ramp(-1.0, Strike, spots.data(), out.data(), spots.size());
+    }
+};
+
+// Pays 1 if the spot ends above the strike.
+struct Digital
+{
+    double Strike;
+    double operator()(double Spot) const {return Spot > Strike ? 1.0 : 0.0;}
+};
+
+// A call plus a put at the same strike: |Spot - Strike|.
+struct Straddle
+{
+    double Strike;
+    double operator()(double Spot) const {return std::abs(Spot - Strike);}
+};
+
+// out[i] = payoff(spots[i]), through the payoff's own batch function if it has
+// one (Call, Put, any Payoff subclass), otherwise a loop the compiler can inline.
+template <typename P>
+void evaluateBatch(const P& payoff, std::span<const double> spots, std::span<double> out)
+{
+    if constexpr (requires {payoff.evaluate(spots, out);}) payoff.evaluate(spots, out);
+    else for(size_t i = 0; i < spots.size(); ++i) out[i] = payoff(spots[i]);
+}
+
+// Lets Poly hold any copyable payoff-like type.
+struct PayoffInterface
+{
+    template <typename T>
+    static constexpr bool accepts = std::is_invocable_r_v<double, const T&, double> && std::is_copy_constructible_v<T>;
+
+    struct VTable
+    {
+        double (*call)(const void*, double);
+        void (*evaluate)(const void*, std::span<const double>, std::span<double>);
+    };
+
+    template <typename T>
+    static constexpr VTable vtable{
+        [](const void* self, double Spot) {return (*static_cast<const T*>(self))(Spot);},
+        [](const void* self, std::span<const double> spots, std::span<double> out) {
+            evaluateBatch(*static_cast<const T*>(self), spots, out);
+        }};
+
+    template <typename Self>
+    struct Methods
+    {
+        double operator()(double Spot) const
+        {
+            const Self& self = static_cast<const Self&>(*this);
+            return self.vtable().call(self.object(), Spot);
+        }
+        void evaluate(std::span<const double> spots, std::span<double> out) const
+        {
+            const Self& self = static_cast<const Self&>(*this);
+            self.vtable().evaluate(self.object(), spots, out);
+        }
+    };
+};
+
+// Four pointers: room for a Payoff subclass with a vptr and up to three doubles.
+inline constexpr size_t AnyPayoffBytes = 4 * sizeof(void*);
+using AnyPayoff = Poly<PayoffInterface, AnyPayoffBytes>;
+
+// Whether AnyPayoff can hold a T inline (Poly's requirements on the stored type).
+template <typename T>
+inline constexpr bool fitsInAnyPayoff = sizeof(T) <= AnyPayoffBytes && alignof(T) <= alignof(void*)
+                                        && std::is_nothrow_move_constructible_v<T>;
+
+// A payoff that does not fit in AnyPayoff, on the heap. It is one pointer, so it
+// fits itself; copying it copies the payoff.
+template <typename T>
+class HeapPayoff
+{
+public:
+    explicit HeapPayoff(const T& p) : payoff{std::make_unique<T>(p)} {}
+    explicit HeapPayoff(T&& p) : payoff{std::make_unique<T>(std::move(p))} {}
+    HeapPayoff(const HeapPayoff& other) : payoff{std::make_unique<T>(*other.payoff)} {}
+    HeapPayoff(HeapPayoff&&) noexcept = default;
+
+    double operator()(double Spot) const {return (*payoff)(Spot);}
+    void evaluate(std::span<const double> spots, std::span<double> out) const {evaluateBatch(*payoff, spots, out);}
+
+private:
+    std::unique_ptr<T> payoff;
+};
+
+class VariantPayoff
+{
+public:
+    using Variant = std::variant<Call, Put, Digital, Straddle, AnyPayoff>;
+
+    // The built-in payoffs become their own alternative, everything else AnyPayoff
+    // (through a HeapPayoff if it is too large).
+    template <typename P>
+        requires (!std::is_same_v<std::decay_t<P>, VariantPayoff>) && PayoffInterface::accepts<std::decay_t<P>>
+    VariantPayoff(P&& p) : payoff{wrap(std::forward<P>(p))} {}
+
+    double operator()(double Spot) const
+    {
+        return std::visit([Spot](const auto& p) {return p(Spot);}, payoff);
+    }
+
+    void evaluate(std::span<const double> spots, std::span<double> out) const
+    {
+        if(spots.size() != out.size()) throw std::invalid_argument("VariantPayoff::evaluate: spots and out differ in size");
+        std::visit([&](const auto& p) {evaluateBatch(p, spots, out);}, payoff);
+    }
+
+    const Variant& variant() const {return payoff;}
+
+private:
+    template <typename P>
+    static Variant wrap(P&& p)
+    {
+        using T = std::decay_t<P>;
+        if constexpr (std::is_same_v<T, Call> || std::is_same_v<T, Put> || std::is_same_v<T, Digital>
+                      || std::is_same_v<T, Straddle> || std::is_same_v<T, AnyPayoff>)
+            return Variant(std::in_place_type<T>, std::forward<P>(p));
+        else if constexpr (fitsInAnyPayoff<T>) return Variant(std::in_place_type<AnyPayoff>, std::forward<P>(p));
+        else return Variant(std::in_place_type<AnyPayoff>, HeapPayoff<T>(std::forward<P>(p)));
+    }
+
+    Variant payoff;
+};
+
+} // namespace ValuePayoffs
+
+/*
+Closed set, open fallback:
+    std::variant only holds the types listed in it; adding a payoff means
+    editing this header. In exchange std::visit knows every alternative at
+    compile time, so it can inline each one's operator() (and the compiler can
+    see that none of them allocates or throws). AnyPayoff keeps the set open:
+    PayoffCall, PayoffPut and any user-defined Payoff subclass still work, at
+    the cost of an indirect call, but without the heap allocation of clone().
+
+What still needs clone()?
+    A payoff known only through a Payoff& or Payoff*: its type, and so its size
+    and copy constructor, are not known at compile time. AnyPayoff is built from
+    the concrete type.
+
+Why spill to the heap instead of raising AnyPayoffBytes?
+    Every VariantPayoff is as large as AnyPayoff, so its size is paid by the
+    Calls and Puts too. The common payoffs fit; a larger one (a basket, a
+    payoff with a table of strikes) still works, with the allocation per copy
+    that clone() had.
+
+Size:
+    A VariantPayoff is as large as its largest alternative, AnyPayoff (a table
+    pointer and 32 bytes), plus the index: 48 bytes on 64-bit, for a Call that
+    needs 8. It is still one cache line, and a vector of them is contiguous.
+*/
@@ -0,0 +1,99 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "mcengine.h"
+
+// The Monte Carlo engine on an at-the-money call and put, checked against the
+// Black-Scholes formula: the effect of antithetic and control variates on the
+// standard error, then throughput for 1, 2, 4, ... threads with the result
+// compared bit for bit across thread counts and repeated runs. Last, zero
+// volatility, where every path is the same and the standard error must be 0.
+// Usage: ./benchmark [paths, default 4000000]
+
+double normalCdf(double x) {return 0.5 * std::erfc(-x / std::sqrt(2.0));}
+
+double blackScholes(const pricing::Market& m, double strike, bool call)
+{
+    double sd = m.Volatility * std::sqrt(m.Maturity);
+    double d1 = (std::log(m.Spot / strike) + (m.Rate + 0.5 * m.Volatility * m.Volatility) * m.Maturity) / sd;
+    double d2 = d1 - sd;
+    double df = std::exp(-m.Rate * m.Maturity);
+    return call ? m.Spot * normalCdf(d1) - strike * df * normalCdf(d2)
+                : strike * df * normalCdf(-d2) - m.Spot * normalCdf(-d1);
+}
+
+bool sameBits(double a, double b) {return std::memcmp(&a, &b, sizeof(double)) == 0;}
+
+int main(int argc, char** argv)
+{
+    uint64_t paths = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+    pricing::Market market{100.0, 0.05, 0.2, 1.0};
+    PayoffCall call(100.0);
+    PayoffPut put(100.0);
+
+    const char* names[] = {"plain", "antithetic", "control variate", "both"};
+    std::printf("S = 100, K = 100, r = 5%%, vol = 20%%, T = 1; %llu paths\n", (unsigned long long)paths);
+    for(bool isCall : {true, false})
+    {
+        pricing::MCEngine engine(isCall ? static_cast<const Payoff&>(call) : put, market);
+        double exact = blackScholes(market, 100.0, isCall);
+        std::printf("%s: Black-Scholes %.6f\n", isCall ? "call" : "put", exact);
+        for(int mode = 0; mode < 4; ++mode)
+        {
+            pricing::SimulationConfig config{.Paths = paths, .Seed = 2024, .Threads = 0,
+                                             .Antithetic = (mode & 1) != 0, .ControlVariate = (mode & 2) != 0};
+            pricing::SimulationResult r = engine.runSimulation(config);
+            std::printf("  %-16s %.6f  s.e. %.6f  error %+.2f s.e.  %6.3f s\n", names[mode], r.Price,
+                        r.StandardError, (r.Price - exact) / r.StandardError, r.Seconds);
+        }
+    }
+
+    pricing::MCEngine engine(call, market);
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("\nthreads (hardware: %u), call, antithetic + control variate\n", hardware);
+    pricing::SimulationConfig config{.Paths = paths, .Seed = 7, .Threads = 1, .Antithetic = true, .ControlVariate = true};
+    pricing::SimulationResult reference = engine.runSimulation(config);
+    for(unsigned t = 1; t <= std::max(4u, hardware); t *= 2)
+    {
+        config.Threads = t;
+        pricing::SimulationResult r = engine.runSimulation(config);
+        pricing::SimulationResult again = engine.runSimulation(config);
+        std::printf("  %3u  %7.1f M paths/s  price %.15f  %s\n", t, r.Paths / r.Seconds * 1e-6, r.Price,
+                    sameBits(r.Price, reference.Price) && sameBits(r.StandardError, reference.StandardError)
+                        && sameBits(again.Price, r.Price) ? "bit-identical" : "DIFFERENT");
+    }
+
+    // No randomness left: S_T = S_0 exp(r T) on every path, so the discounted
+    // payoff of a call struck at 90 is S_0 - 90 exp(-r T) with no error at all.
+    pricing::Market flat{100.0, 0.05, 0.0, 1.0};
+    pricing::MCEngine degenerate(PayoffCall(90.0), flat);
+    double exactFlat = 100.0 - 90.0 * std::exp(-0.05);
+    std::printf("\nvol = 0, K = 90: exact %.6f\n", exactFlat);
+    for(int mode = 0; mode < 4; ++mode)
+    {
+        pricing::SimulationConfig flatConfig{.Paths = paths, .Seed = 2024, .Threads = 0,
+                                             .Antithetic = (mode & 1) != 0, .ControlVariate = (mode & 2) != 0};
+        pricing::SimulationResult r = degenerate.runSimulation(flatConfig);
+        std::printf("  %-16s %.6f  s.e. %.3g  %s\n", names[mode], r.Price, r.StandardError,
+                    std::isfinite(r.StandardError) && r.StandardError >= 0 ? "ok" : "BAD STANDARD ERROR");
+    }
+}
+
+/*
+Reading the numbers:
+    The errors should be within a few standard errors of the formula.
+    Antithetic variates cut the standard error by about 30% for the same number
+    of paths, and take less time, since each normal drawn gives two paths. The
+    control variate (S_T) does better for the at-the-money call, which moves
+    almost linearly with S_T. Call and put end up with the same standard error
+    under the control: by put-call parity their payoffs differ by S_T - K, which
+    is linear in the control and removed with it.
+    Throughput grows with the thread count up to the number of hardware
+    threads; beyond that (and on a single-core machine) the numbers only vary
+    by noise. The price is bit-identical at every thread count.
+    With zero volatility the standard error is 0, or a few ulps from the
+    rounding of the batch means: the engine keeps centred sums, which cannot go
+    negative, where E[f^2] - E[f]^2 would cancel to noise and give a NaN root.
+*/
@@ -0,0 +1,307 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../item_07/payoff.h"
+
+// Monte Carlo pricing of a European payoff under geometric Brownian motion:
+//
+//     S_T = S_0 exp((r - sigma^2 / 2) T + sigma sqrt(T) Z),   Z ~ N(0, 1)
+//     price = exp(-r T) E[payoff(S_T)]
+//
+//     pricing::MCEngine engine(PayoffCall(100.0), {100.0, 0.05, 0.2, 1.0});
+//     pricing::SimulationResult r = engine.runSimulation({.Paths = 10'000'000, .Seed = 7,
+//                                                         .Antithetic = true, .ControlVariate = true});
+//
+// The paths are cut into chunks of ChunkSamples, each with its own random number
+// stream, and worker threads take chunks as they finish the previous one. Each
+// chunk's sums are kept separately and added up in chunk order, so the result
+// depends only on the seed and the number of paths: the same bits for 1 thread
+// or 64, and for every run.
+
+namespace pricing
+{
+
+struct Market
+{
+    double Spot;
+    double Rate;       // continuously compounded, per year
+    double Volatility; // per sqrt(year)
+    double Maturity;   // in years
+};
+
+struct SimulationConfig
+{
+    uint64_t Paths = 1'000'000;
+    uint64_t Seed = 1;
+    unsigned Threads = 0;        // 0: one per hardware thread
+    bool Antithetic = false;     // pair each Z with -Z
+    bool ControlVariate = false; // use S_T, whose expectation is known, as a control
+};
+
+struct SimulationResult
+{
+    double Price;
+    double StandardError;
+    uint64_t Paths;
+    unsigned Threads;
+    double Seconds;
+};
+
+// xoshiro256++ (Blackman and Vigna): small, fast, and with a jump() that advances
+// it by 2^128 steps, which cuts its period into non-overlapping streams.
+class Xoshiro256
+{
+public:
+    explicit Xoshiro256(uint64_t seed)
+    {
+        for(uint64_t& w : s) w = splitMix(seed); // expands the seed into a full state
+    }
+
+    uint64_t operator()()
+    {
+        uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform in (0, 1]: the top 53 bits, shifted off zero so that log() is finite.
+    double uniform() {return double(((*this)() >> 11) + 1) * 0x1.0p-53;}
+
+    void jump()
+    {
+        static constexpr uint64_t Jump[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+                                            0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+        uint64_t t[4] = {};
+        for(uint64_t j : Jump)
+            for(int b = 0; b < 64; ++b)
+            {
+                if(j & (uint64_t(1) << b))
+                    for(int k = 0; k < 4; ++k) t[k] ^= s[k];
+                (*this)();
+            }
+        for(int k = 0; k < 4; ++k) s[k] = t[k];
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {return (x << k) | (x >> (64 - k));}
+
+    static uint64_t splitMix(uint64_t& x)
+    {
+        uint64_t z = (x += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t s[4];
+};
+
+class MCEngine
+{
+public:
+    static constexpr uint64_t ChunkSamples = 1 << 15;
+    static constexpr size_t BatchSamples = 2048; // spots per Payoff::evaluate call (twice that if antithetic)
+
+    // Keeps its own copy of the payoff (Payoff::clone), so the engine may outlive it.
+    MCEngine(const Payoff& payoff_, const Market& market_) : payoff{payoff_.clone()}, market{market_}
+    {
+        if(!(market.Spot > 0) || !(market.Volatility >= 0) || !(market.Maturity >= 0))
+            throw std::invalid_argument("MCEngine: spot must be positive, volatility and maturity non-negative");
+    }
+
+    // Throws std::invalid_argument for fewer than two samples, and rethrows the
+    // first exception thrown by the payoff in any worker.
+    SimulationResult runSimulation(const SimulationConfig& config) const
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        unsigned threads = config.Threads ? config.Threads : std::max(1u, std::thread::hardware_concurrency());
+        // With antithetic variates one sample is the average over a pair of paths.
+        uint64_t samples = config.Antithetic ? config.Paths / 2 : config.Paths;
+        if(samples < 2) throw std::invalid_argument("MCEngine: too few paths");
+
+        size_t chunks = (samples + ChunkSamples - 1) / ChunkSamples;
+        std::vector<Xoshiro256> streams;
+        streams.reserve(chunks);
+        Xoshiro256 generator(config.Seed);
+        for(size_t c = 0; c < chunks; ++c)
+        {
+            streams.push_back(generator);
+            generator.jump();
+        }
+
+        std::vector<Sums> partial(chunks);
+        std::vector<std::exception_ptr> errors(threads);
+        std::atomic<size_t> next{0};
+        auto worker = [&](unsigned t) {
+            try
+            {
+                for(size_t c; (c = next++) < chunks;)
+                    partial[c] = simulateChunk(streams[c], std::min(ChunkSamples, samples - c * ChunkSamples),
+                                               config.Antithetic);
+            }
+            catch(...)
+            {
+                errors[t] = std::current_exception();
+                next = chunks; // the others stop after their current chunk
+            }
+        };
+        {
+            std::vector<std::jthread> pool;
+            for(unsigned t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+            worker(0);
+        } // joined here
+        for(const std::exception_ptr& e : errors)
+            if(e) std::rethrow_exception(e);
+
+        Sums total;
+        for(const Sums& p : partial) total += p;
+        SimulationResult result = estimate(total, config.ControlVariate);
+        result.Paths = config.Antithetic ? 2 * samples : samples;
+        result.Threads = threads;
+        result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        return result;
+    }
+
+private:
+    // Per sample: f the payoff, x = S_T - E[S_T] the control. Kept as means and
+    // sums of centred products, which are never negative, rather than raw sums of
+    // squares, whose difference cancels to rounding noise (or below zero) when
+    // the samples barely vary.
+    struct Sums
+    {
+        uint64_t n{0};
+        double meanF{0}, meanX{0};
+        double m2F{0}, m2X{0}, cFX{0}; // sum (f - meanF)^2, (x - meanX)^2, (f - meanF)(x - meanX)
+
+        // Chan et al.'s pairwise merge: exact up to rounding, and deterministic
+        // as long as the merges happen in the same order.
+        Sums& operator+=(const Sums& o)
+        {
+            if(o.n == 0) return *this;
+            if(n == 0) return *this = o;
+            double total = double(n + o.n), dF = o.meanF - meanF, dX = o.meanX - meanX;
+            double w = double(n) * double(o.n) / total;
+            m2F += o.m2F + dF * dF * w;
+            m2X += o.m2X + dX * dX * w;
+            cFX += o.cFX + dF * dX * w;
+            meanF += dF * double(o.n) / total;
+            meanX += dX * double(o.n) / total;
+            n += o.n;
+            return *this;
+        }
+    };
+
+    Sums simulateChunk(Xoshiro256 rng, uint64_t samples, bool antithetic) const
+    {
+        const double drift = (market.Rate - 0.5 * market.Volatility * market.Volatility) * market.Maturity;
+        const double vol = market.Volatility * std::sqrt(market.Maturity);
+        const double expectedSpot = market.Spot * std::exp(market.Rate * market.Maturity);
+        std::vector<double> z(BatchSamples), spots(2 * BatchSamples), values(2 * BatchSamples);
+        std::vector<double> fs(BatchSamples), xs(BatchSamples);
+        Sums s;
+        for(uint64_t done = 0; done < samples; done += BatchSamples)
+        {
+            size_t b = std::min<uint64_t>(BatchSamples, samples - done);
+            // Box-Muller: two uniforms give two independent normals.
+            for(size_t i = 0; i < b; i += 2)
+            {
+                double r = std::sqrt(-2.0 * std::log(rng.uniform()));
+                double theta = 2.0 * std::numbers::pi * rng.uniform();
+                z[i] = r * std::cos(theta);
+                if(i + 1 < b) z[i+1] = r * std::sin(theta);
+            }
+            for(size_t i = 0; i < b; ++i) spots[i] = market.Spot * std::exp(drift + vol * z[i]);
+            if(antithetic)
+                for(size_t i = 0; i < b; ++i) spots[b+i] = market.Spot * std::exp(drift - vol * z[i]);
+            size_t m = antithetic ? 2 * b : b;
+            payoff->evaluate(std::span<const double>(spots.data(), m), std::span<double>(values.data(), m));
+            // Two passes over the batch: its means, then the centred sums around them.
+            Sums batch;
+            batch.n = b;
+            for(size_t i = 0; i < b; ++i)
+            {
+                fs[i] = antithetic ? 0.5 * (values[i] + values[b+i]) : values[i];
+                xs[i] = (antithetic ? 0.5 * (spots[i] + spots[b+i]) : spots[i]) - expectedSpot;
+                batch.meanF += fs[i];
+                batch.meanX += xs[i];
+            }
+            batch.meanF /= double(b);
+            batch.meanX /= double(b);
+            for(size_t i = 0; i < b; ++i)
+            {
+                double df = fs[i] - batch.meanF, dx = xs[i] - batch.meanX;
+                batch.m2F += df * df; batch.m2X += dx * dx; batch.cFX += df * dx;
+            }
+            s += batch;
+        }
+        return s;
+    }
+
+    SimulationResult estimate(const Sums& s, bool controlVariate) const
+    {
+        double n = double(s.n);
+        double varF = s.m2F / (n - 1);
+        double mean = s.meanF, var = varF;
+        if(controlVariate)
+        {
+            // f - beta x has the same expectation as f (E[x] = 0) and, for the
+            // beta estimated from the sample, the least variance.
+            double varX = s.m2X / (n - 1);
+            double cov = s.cFX / (n - 1);
+            if(varX > 0)
+            {
+                double beta = cov / varX;
+                mean = s.meanF - beta * s.meanX;
+                var = std::max(0.0, varF - beta * cov);
+            }
+        }
+        double discount = std::exp(-market.Rate * market.Maturity);
+        return {discount * mean, discount * std::sqrt(var / n), 0, 0, 0.0};
+    }
+
+    std::unique_ptr<Payoff> payoff;
+    Market market;
+};
+
+} // namespace pricing
+
+/*
+Why chunks, and not one stream per thread?
+    With one stream per thread, path i would get different random numbers for
+    different thread counts, and the order in which the threads' sums are added
+    would change too: the price would differ in the last digits from one
+    machine to the next. Tying the streams to chunks of paths instead makes the
+    result a function of (seed, paths) alone. Taking chunks from a shared
+    counter also balances the load when some threads run slower.
+
+Variance reduction:
+    Antithetic: Z and -Z are equally likely, so averaging the payoffs of both
+    paths leaves the expectation unchanged; for a monotone payoff the two are
+    negatively correlated, and the average varies less than two independent
+    paths would.
+    Control variate: E[S_T] = S_0 exp(r T) is known exactly. Subtracting
+    beta (S_T - E[S_T]) removes the part of the payoff that moves with S_T; for
+    an in-the-money call that is most of it. beta is estimated from the same
+    paths, which biases the price by O(1 / paths), far below the standard error.
+
+Exceptions (Item 8):
+    An exception thrown by the payoff in a worker thread is caught there, kept
+    as an exception_ptr and rethrown by runSimulation once all workers are
+    joined; it never escapes a thread or a destructor.
+*/
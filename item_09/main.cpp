@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include "../item_38/concat.h"
 
 
 class Base
@@ -102,7 +103,7 @@ public:
 class BuyTransaction : public Transaction
 {
 public:
-    BuyTransaction() : Transaction{createLogString()}
+    BuyTransaction(int quantity, double price) : Transaction{createLogString(quantity, price)}
     {
         std::cout << "Calling BuyTransaction constructor\n";
     }
@@ -111,17 +112,16 @@ public:
         std::cout << "Calling BuyTransaction destructor\n";
     }
 private:
-    static std::string createLogString()
+    static std::string createLogString(int quantity, double price)
     {
-        std::string log("Logging Buy Transaction");
-        return log;
+        return concat("Logging Buy Transaction: ", quantity, " @ ", price); // one allocation
     }
 };
 
 class SellTransaction : public Transaction
 {
 public:
-    SellTransaction() : Transaction{createLogString()}
+    SellTransaction(int quantity, double price) : Transaction{createLogString(quantity, price)}
     {
         std::cout << "Calling SellTransaction constructor\n";
     }
@@ -130,10 +130,9 @@ public:
         std::cout << "Calling SellTransaction destructor\n";
     }
 private:
-    static std::string createLogString()
+    static std::string createLogString(int quantity, double price)
     {
-        std::string log("Logging Sell Transaction");
-        return log;
+        return concat("Logging Sell Transaction: ", quantity, " @ ", price); // one allocation
     }
 };
 
@@ -148,8 +147,8 @@ int main()
     //BuyTransactionUnsafe b; // error due to call to pure virtual logTransaction();
     //SellTransactionUnsafe s;
 
-    BuyTransaction b;
-    SellTransaction s;
+    BuyTransaction b(100, 12.5);
+    SellTransaction s(40, 12.75);
 
 }
 
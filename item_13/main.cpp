@@ -1,7 +1,14 @@
 #include <iostream>
+#include <memory>
 #include <string>
 #include <stdexcept>
 
+#ifdef TRACK_LEAKS
+// g++ -std=c++20 -O2 -DTRACK_LEAKS -rdynamic main.cpp && ./a.out
+// Routes every allocation through memalloc2's hooks and reports what was never freed.
+#include "../memalloc2/newhooks.h"
+#endif
+
 class Investment
 {
 public:
@@ -76,10 +83,16 @@ void sharedptrExample()
 
 int main()
 {
+#ifdef TRACK_LEAKS
+    LeakTracker::enable();
+#endif
     rawptrExample();
     uniqueptrExample();
     sharedptrExample();
 
+#ifdef TRACK_LEAKS
+    LeakTracker::report(std::cout); // expected: the Stock leaked by rawptrExample, allocated in createInvestment
+#endif
     return 0;
 }
 
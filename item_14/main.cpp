@@ -3,6 +3,12 @@
 #include <mutex>
 #include <string>
 
+#ifdef CHECK_NOALLOC
+// g++ -std=c++20 -DCHECK_NOALLOC main.cpp && ./a.out
+// Aborts if moving a MovableResource touches the heap (see memalloc2/noallocscope.h).
+#include "../memalloc2/newhooks.h"
+#endif
+
 /* 1. Prohibit Copying */
 
 class Lock
@@ -155,6 +161,9 @@ int main()
     // 4. Transfer ownership
     {
         MovableResource r1("DB Connection");
+#ifdef CHECK_NOALLOC
+        NoAllocScope guard(NoAllocScope::Mode::Abort); // a move only transfers the unique_ptr
+#endif
         MovableResource r2 = std::move(r1);
         r1.print();
         r2.print();
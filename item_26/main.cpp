@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <memory_resource>
+#include "../memalloc2/newhooks.h" // global operator new/delete that honour ArenaScope
 
 constexpr size_t MinimumPasswordLength = 8;
 
@@ -43,6 +45,28 @@ void approachB(const std::vector<T>& data)
     }
 }
 
+// Same as approachB, but every allocation inside the loop comes from a bump-pointer
+// arena: the n ctors still run, but they no longer pay for n malloc/free pairs.
+template <typename T>
+void approachBArena(const std::vector<T>& data)
+{
+    ArenaScope arena; // everything allocated until the end of this scope goes to the arena
+    for(auto& val : data)
+    {
+        T obj{val}; // n ctor + n dtor calls, each dtor hands its block straight back to the arena
+    }
+} // whole arena released here at once
+
+// Explicit version with std::pmr: the container is told which memory_resource to use.
+void approachBPmr(const std::vector<std::vector<int>>& data)
+{
+    MonotonicArena arena;
+    for(auto& val : data)
+    {
+        std::pmr::vector<int> obj{val.begin(), val.end(), &arena};
+    }
+}
+
 using Clock = std::chrono::high_resolution_clock;
 
 int main()
@@ -71,9 +95,12 @@ int main()
     auto t2 = Clock::now();
     approachB(strings);
     auto t3 = Clock::now();
+    approachBArena(strings);
+    auto t4 = Clock::now();
 
     std::cout << "Strings - Approach A time: " << std::chrono::duration<double>(t2 - t1).count() << "s\n";
     std::cout << "Strings - Approach B time: " << std::chrono::duration<double>(t3 - t2).count() << "s\n";
+    std::cout << "Strings - Approach B (arena) time: " << std::chrono::duration<double>(t4 - t3).count() << "s\n";
 
     // Case 2: std::vector<int> (ctor and dtor are expensive because they are doing memory allocation in the heap).
     // in contrast, in approachA the same memory allocated (and deallocated) once is reused and no expensive ctor/dtor 
@@ -89,11 +116,19 @@ int main()
     t2 = Clock::now();
     approachB(vectors);
     t3 = Clock::now();
+    approachBArena(vectors);
+    t4 = Clock::now();
+    approachBPmr(vectors);
+    auto t5 = Clock::now();
 
     std::cout << "Vectors - Approach A time: "
               << std::chrono::duration<double>(t2 - t1).count() << "s\n";
     std::cout << "Vectors - Approach B time: "
               << std::chrono::duration<double>(t3 - t2).count() << "s\n";
+    std::cout << "Vectors - Approach B (arena) time: "
+              << std::chrono::duration<double>(t4 - t3).count() << "s\n";
+    std::cout << "Vectors - Approach B (pmr arena) time: "
+              << std::chrono::duration<double>(t5 - t4).count() << "s\n";
 }
 
 /*
@@ -112,4 +147,9 @@ Postpone variable definitions until the moment of use:
 Rule of thumb: define variables as late as possible, with
    meaningful initialization arguments, and in the smallest scope.
 
+5. Most of the cost of "define inside the loop" is the allocation, not the
+   constructor. approachBArena keeps the readable inside-the-loop definition but
+   serves the allocations from a monotonic arena (ArenaScope, memalloc2/arena.h),
+   which makes it competitive with approachA.
+
 */
\ No newline at end of file
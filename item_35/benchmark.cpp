@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <variant>
+#include <vector>
+#include "virtual.h"
+#include "templategc.h"
+#include "strategyfungc.h"
+#include "strategyclassicgc.h"
+#include "characterstore.h"
+
+// Cost of one healthValue() call for each way item 35 dispatches it, plus CRTP
+// (as in crtp/) and std::variant + std::visit, over millions of characters in
+// three layouts:
+//   mono      every character is of the same kind: the indirect branch always goes
+//             to the same target and is perfectly predicted
+//   sorted    all kinds, grouped by kind: a misprediction only at each group boundary
+//   shuffled  all kinds in random order: the target is unpredictable
+// Characters are always created in container order, so memory access is sequential
+// in every layout and the shuffled column measures dispatch, not cache misses.
+// usage: ./benchmark [characters]
+
+using Clock = std::chrono::steady_clock;
+
+enum class Layout {Mono, Sorted, Shuffled};
+
+// The kind (0 .. kinds-1) of each character, in container order.
+std::vector<int> makeKinds(size_t n, int kinds, Layout layout)
+{
+    std::vector<int> k(n);
+    for(size_t i = 0; i < n; ++i) k[i] = layout == Layout::Mono ? kinds - 1 : static_cast<int>(i % kinds);
+    if(layout == Layout::Sorted) std::sort(k.begin(), k.end());
+    if(layout == Layout::Shuffled) std::shuffle(k.begin(), k.end(), std::mt19937{42});
+    return k;
+}
+
+template <typename Container, typename F>
+double nsPerCall(const Container& chars, F&& health)
+{
+    constexpr int Runs = 5;
+    long long sink = 0;
+    for(const auto& c : chars) sink += health(c); // warm-up
+    auto t0 = Clock::now();
+    for(int r = 0; r < Runs; ++r)
+    {
+        for(const auto& c : chars) sink += health(c);
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / (Runs * chars.size());
+    if(sink == 42) std::puts(""); // keep the work observable
+    return ns;
+}
+
+double virtualCall(size_t n, Layout layout)
+{
+    using namespace VirtualApproach;
+    std::vector<std::unique_ptr<GameCharacter>> chars;
+    for(int k : makeKinds(n, 2, layout))
+    {
+        if(k == 0) chars.push_back(std::make_unique<GameCharacter>(80));
+        else chars.push_back(std::make_unique<Warrior>(50));
+    }
+    return nsPerCall(chars, [](const auto& c){return c->healthValue();});
+}
+
+double nvi(size_t n, Layout layout)
+{
+    using namespace TemplateApproach;
+    std::vector<std::unique_ptr<GameCharacter>> chars;
+    for(int k : makeKinds(n, 2, layout))
+    {
+        if(k == 0) chars.push_back(std::make_unique<GameCharacter>(80));
+        else chars.push_back(std::make_unique<Warrior>(50));
+    }
+    return nsPerCall(chars, [](const auto& c){return c->healthValue();});
+}
+
+double functionStrategy(size_t n, Layout layout)
+{
+    using namespace StratFunApproach;
+    std::vector<GameCharacter> chars;
+    chars.reserve(n);
+    for(int k : makeKinds(n, 3, layout))
+    {
+        if(k == 0) chars.emplace_back(loseHealthFast);
+        else if(k == 1) chars.emplace_back(loseHealthSlow());
+        else chars.emplace_back(loseHealthSuperSlow);
+    }
+    return nsPerCall(chars, [](const GameCharacter& c){return c.healthValue();});
+}
+
+double classicStrategy(size_t n, Layout layout)
+{
+    using namespace ClassicStrategyApproach;
+    std::vector<GameCharacter> chars;
+    chars.reserve(n);
+    for(int k : makeKinds(n, 3, layout))
+    {
+        if(k == 0) chars.emplace_back(StrategyRegistry::get<HealthCalculator>());
+        else if(k == 1) chars.emplace_back(StrategyRegistry::get<FastDecay>());
+        else chars.emplace_back(StrategyRegistry::get<SlowDecay>());
+    }
+    return nsPerCall(chars, [](const GameCharacter& c){return c.healthValue();});
+}
+
+// CRTP, as in crtp/: healthValue is resolved at compile time. The price is that
+// there is no common base type, so each kind lives in its own container and a
+// "mixed" population is a loop per kind; there is no shuffled order to speak of.
+namespace CrtpApproach
+{
+template <typename Derived>
+class GameCharacter
+{
+public:
+    int healthValue() const {return static_cast<const Derived&>(*this).doHealthValue();}
+};
+
+class Plain : public GameCharacter<Plain>
+{
+public:
+    Plain(int Health_) : Health{Health_} {}
+    int doHealthValue() const {return Health;}
+private:
+    int Health;
+};
+
+class Warrior : public GameCharacter<Warrior>
+{
+public:
+    Warrior(int Strength_) : Strength{Strength_} {}
+    int doHealthValue() const {return 100 - Strength;}
+private:
+    int Strength;
+};
+} // namespace CrtpApproach
+
+double crtp(size_t n, Layout layout)
+{
+    using namespace CrtpApproach;
+    std::vector<Plain> plain;
+    std::vector<Warrior> warriors;
+    for(int k : makeKinds(n, 2, layout))
+    {
+        if(k == 0) plain.emplace_back(80);
+        else warriors.emplace_back(50);
+    }
+    auto health = [](const auto& c){return c.healthValue();};
+    double ns = 0;
+    if(!plain.empty()) ns += nsPerCall(plain, health) * plain.size();
+    if(!warriors.empty()) ns += nsPerCall(warriors, health) * warriors.size();
+    return ns / n;
+}
+
+// A closed set of kinds stored by value: one contiguous array, dispatch by index.
+namespace VariantApproach
+{
+struct Plain
+{
+    int Health;
+    int healthValue() const {return Health;}
+};
+
+struct Warrior
+{
+    int Strength;
+    int healthValue() const {return 100 - Strength;}
+};
+
+using GameCharacter = std::variant<Plain, Warrior>;
+} // namespace VariantApproach
+
+double variantVisit(size_t n, Layout layout)
+{
+    using namespace VariantApproach;
+    std::vector<GameCharacter> chars;
+    chars.reserve(n);
+    for(int k : makeKinds(n, 2, layout))
+    {
+        if(k == 0) chars.emplace_back(Plain{80});
+        else chars.emplace_back(Warrior{50});
+    }
+    return nsPerCall(chars, [](const GameCharacter& c){return std::visit([](const auto& x){return x.healthValue();}, c);});
+}
+
+// The structure-of-arrays store: characters are bucketed by strategy whatever the
+// order they were added in, and health is computed a whole bucket at a time.
+double soaStore(size_t n, Layout layout)
+{
+    using namespace DataOrientedApproach;
+    CharacterStore<Default, Warrior> store;
+    for(int k : makeKinds(n, 2, layout))
+    {
+        if(k == 0) store.add<Default>(80);
+        else store.add<Warrior>(100, 50);
+    }
+    std::vector<int> health(n);
+    constexpr int Runs = 5;
+    long long sink = 0;
+    store.healthValues(health); // warm-up
+    auto t0 = Clock::now();
+    for(int r = 0; r < Runs; ++r)
+    {
+        store.healthValues(health);
+        sink += health[r];
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / (Runs * n);
+    if(sink == 42) std::puts(""); // keep the work observable
+    return ns;
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+    struct Approach {const char* name; double (*run)(size_t, Layout);};
+    const Approach approaches[] = {
+        {"virtual", virtualCall},
+        {"NVI (template method)", nvi},
+        {"SmallFunction strategy", functionStrategy},
+        {"classic strategy (flyweight)", classicStrategy},
+        {"CRTP (one vector per kind)", crtp},
+        {"std::variant + std::visit", variantVisit},
+        {"SoA store, bucketed", soaStore},
+    };
+    std::printf("%zu characters, ns per healthValue() call\n\n", n);
+    std::printf("%-30s %9s %9s %9s\n", "approach", "mono", "sorted", "shuffled");
+    for(const Approach& a : approaches)
+    {
+        double mono = a.run(n, Layout::Mono);
+        double sorted = a.run(n, Layout::Sorted);
+        double shuffled = a.run(n, Layout::Shuffled);
+        std::printf("%-30s %9.2f %9.2f %9.2f\n", a.name, mono, sorted, shuffled);
+    }
+}
+
+/*
+What to expect:
+    mono and sorted: every approach costs a few ns, since the branch predictor
+    learns the single target. CRTP and std::variant are the cheapest because the
+    call can be inlined (CRTP) or is a jump table over a small closed set that
+    the compiler often turns into a branch (variant), and the characters sit
+    contiguously by value.
+    shuffled: the call target is mispredicted about half the time with two kinds
+    and two thirds with three, roughly 15-20 cycles each, so virtual, NVI, SmallFunction and
+    the classic strategy all slow down several times. The classic strategy pays
+    one more dependent load (character -> strategy -> vptr) than virtual.
+    std::variant mispredicts too, but on a cheap conditional branch. CRTP has no
+    shuffled layout: the kinds are kept apart, so there is nothing to mispredict.
+    The SoA store does the same for any insertion order and evaluates a bucket
+    with SIMD, writing every result: well under 1 ns per character.
+*/
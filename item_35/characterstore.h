@@ -0,0 +1,184 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace DataOrientedApproach
+{
+
+// Health strategies as plain types: a static function of the character's fields.
+// They play the role of the virtual overrides / strategy objects of the other
+// approaches, but are chosen per bucket instead of per object.
+struct Default   {static int health(int Health, int) {return Health;}};
+struct Warrior   {static int health(int Health, int Strength) {return Health - Strength;}};
+struct FastDecay {static int health(int, int) {return 50;}};
+struct SlowDecay {static int health(int, int) {return 200;}};
+
+// Identifies one character for as long as it exists. The generation makes a
+// handle to a removed character invalid, even after its slot has been reused.
+struct Handle
+{
+    uint32_t slot;
+    uint32_t generation;
+};
+
+// Structure-of-arrays store of game characters, bucketed by health strategy.
+// Each bucket keeps every field in its own contiguous column, so computing the
+// health of a whole bucket is a single loop over two int arrays with the
+// strategy inlined: no pointer per character, no indirect call, vectorisable.
+// Characters move within their bucket when others are removed; handles stay valid.
+template <typename... Strategies>
+class CharacterStore
+{
+public:
+    template <typename Strategy>
+    Handle add(int Health, int Strength = 0)
+    {
+        constexpr uint32_t b = indexOf<Strategy>();
+        Bucket& bucket = buckets[b];
+        uint32_t slot;
+        if(freeSlots.empty())
+        {
+            slot = static_cast<uint32_t>(slots.size());
+            slots.push_back({});
+        }
+        else
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        slots[slot].bucket = b;
+        slots[slot].row = static_cast<uint32_t>(bucket.Health.size());
+        bucket.Health.push_back(Health);
+        bucket.Strength.push_back(Strength);
+        bucket.slot.push_back(slot);
+        return {slot, slots[slot].generation};
+    }
+
+    // Swap-and-pop: the last character of the bucket takes the removed one's row.
+    void remove(Handle h)
+    {
+        if(!valid(h)) return;
+        Slot& s = slots[h.slot];
+        Bucket& bucket = buckets[s.bucket];
+        uint32_t last = static_cast<uint32_t>(bucket.Health.size() - 1);
+        bucket.Health[s.row] = bucket.Health[last];
+        bucket.Strength[s.row] = bucket.Strength[last];
+        bucket.slot[s.row] = bucket.slot[last];
+        slots[bucket.slot[s.row]].row = s.row;
+        bucket.Health.pop_back();
+        bucket.Strength.pop_back();
+        bucket.slot.pop_back();
+        ++s.generation;
+        freeSlots.push_back(h.slot);
+    }
+
+    bool valid(Handle h) const {return h.slot < slots.size() && slots[h.slot].generation == h.generation;}
+
+    int& health(Handle h) {return buckets[slots[h.slot].bucket].Health[slots[h.slot].row];}
+    int& strength(Handle h) {return buckets[slots[h.slot].bucket].Strength[slots[h.slot].row];}
+
+    // One character: a lookup through a table of the strategies' functions.
+    int healthValue(Handle h) const
+    {
+        static constexpr int (*strategyHealth[])(int, int) = {&Strategies::health...};
+        const Slot& s = slots[h.slot];
+        const Bucket& bucket = buckets[s.bucket];
+        return strategyHealth[s.bucket](bucket.Health[s.row], bucket.Strength[s.row]);
+    }
+
+    size_t size() const
+    {
+        size_t n = 0;
+        for(const Bucket& b : buckets) n += b.Health.size();
+        return n;
+    }
+
+    // The health of every character, bucket after bucket, into out[0 .. size()).
+    // handleAt(i) says which character out[i] belongs to. Throws std::invalid_argument
+    // if out has fewer than size() elements.
+    void healthValues(std::span<int> out) const
+    {
+        if(out.size() < size()) throw std::invalid_argument("CharacterStore::healthValues: out is smaller than size()");
+        evaluate(out, std::index_sequence_for<Strategies...>{});
+    }
+
+    Handle handleAt(size_t position) const
+    {
+        for(const Bucket& b : buckets)
+        {
+            if(position < b.slot.size())
+            {
+                uint32_t slot = b.slot[position];
+                return {slot, slots[slot].generation};
+            }
+            position -= b.slot.size();
+        }
+        return {static_cast<uint32_t>(slots.size()), 0}; // out of range: not valid()
+    }
+
+private:
+    struct Bucket
+    {
+        std::vector<int> Health;
+        std::vector<int> Strength;
+        std::vector<uint32_t> slot; // row -> slot, to fix up the slot when a row moves
+    };
+
+    struct Slot
+    {
+        uint32_t bucket{0};
+        uint32_t row{0};
+        uint32_t generation{0};
+    };
+
+    template <typename Strategy>
+    static constexpr uint32_t indexOf()
+    {
+        constexpr bool match[] = {std::is_same_v<Strategy, Strategies>...};
+        for(uint32_t i = 0; i < sizeof...(Strategies); ++i) if(match[i]) return i;
+        static_assert((std::is_same_v<Strategy, Strategies> || ...), "strategy is not part of this store");
+        return 0;
+    }
+
+    template <typename Strategy>
+    static void evaluateBucket(const Bucket& bucket, int* out)
+    {
+        const int* h = bucket.Health.data();
+        const int* s = bucket.Strength.data();
+        size_t n = bucket.Health.size();
+        for(size_t i = 0; i < n; ++i) out[i] = Strategy::health(h[i], s[i]);
+    }
+
+    template <size_t... I>
+    void evaluate(std::span<int> out, std::index_sequence<I...>) const
+    {
+        int* p = out.data();
+        ((evaluateBucket<Strategies>(buckets[I], p), p += buckets[I].Health.size()), ...);
+    }
+
+    std::array<Bucket, sizeof...(Strategies)> buckets;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+};
+
+} // namespace DataOrientedApproach
+
+/*
+Data-oriented design:
+    The other approaches store one object per character, each carrying its own
+    behaviour (a vptr, a std::function, a shared_ptr). Evaluating a population is
+    then one indirect call per character, and the fields needed are scattered
+    across objects. Here the behaviour is a property of the bucket, not of the
+    object: all characters with the same strategy sit together, and each field is
+    a contiguous array. The loop per bucket touches only the columns it needs and
+    the compiler turns it into SIMD code.
+Drawbacks:
+    - The set of strategies is fixed at compile time.
+    - Changing a character's strategy means moving it to another bucket.
+    - Characters are reached through handles, not pointers or references.
+*/
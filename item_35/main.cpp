@@ -3,7 +3,9 @@
 #include "templategc.h"
 #include "strategyfungc.h"
 #include "strategyclassicgc.h"
+#include "characterstore.h"
 #include <memory>
+#include <vector>
 
 int main()
 {
@@ -27,14 +29,36 @@ int main()
     std::cout << "gc1 Health: " << gc1.healthValue() << "\n";
     std::cout << "gc2 Health: " << gc2.healthValue() << "\n";
     std::cout << "gc2 Health: " << gc3.healthValue() << "\n";
-
-    // Classic Strategy approach
-    ClassicStrategyApproach::GameCharacter csgc1(std::make_shared<ClassicStrategyApproach::HealthCalculator>());
-    ClassicStrategyApproach::GameCharacter csgc2(std::make_shared<ClassicStrategyApproach::FastDecay>());
-    ClassicStrategyApproach::GameCharacter csgc3(std::make_shared<ClassicStrategyApproach::SlowDecay>());
+    std::cout << "gc1 Health if it decayed slowly: " << gc1.healthValue(StratFunApproach::loseHealthSlow()) << "\n";
+
+    // Classic Strategy approach: strategies are flyweights, characters only point to them
+    using ClassicStrategyApproach::StrategyRegistry;
+    ClassicStrategyApproach::GameCharacter csgc1(StrategyRegistry::get<ClassicStrategyApproach::HealthCalculator>());
+    ClassicStrategyApproach::GameCharacter csgc2(StrategyRegistry::get<ClassicStrategyApproach::FastDecay>());
+    ClassicStrategyApproach::GameCharacter csgc3(StrategyRegistry::get<ClassicStrategyApproach::SlowDecay>());
+    auto proportional = StrategyRegistry::make<ClassicStrategyApproach::ProportionalDecay>(0.25); // stateful: owned here
+    ClassicStrategyApproach::GameCharacter csgc4(*proportional);
     std::cout << "csgc1 Health: " << csgc1.healthValue() << "\n";
     std::cout << "csgc2 Health: " << csgc2.healthValue() << "\n";
     std::cout << "csgc2 Health: " << csgc3.healthValue() << "\n";
+    std::cout << "csgc4 Health: " << csgc4.healthValue() << "\n";
+
+    // Data-oriented approach: characters bucketed by strategy, fields in columns
+    using namespace DataOrientedApproach;
+    CharacterStore<Default, Warrior, FastDecay, SlowDecay> store;
+    Handle dg = store.add<Default>(80);
+    Handle dw = store.add<Warrior>(100, 50);
+    Handle dfast = store.add<FastDecay>(100);
+    store.add<SlowDecay>(100);
+    std::cout << "dg Health: " << store.healthValue(dg) << "\n";
+    std::cout << "dw Health: " << store.healthValue(dw) << "\n";
+    store.remove(dfast);
+    std::cout << "dfast still valid after remove: " << store.valid(dfast) << "\n";
+    std::vector<int> health(store.size());
+    store.healthValues(health); // one tight loop per bucket
+    std::cout << "All characters' health:";
+    for(int h : health) std::cout << " " << h;
+    std::cout << "\n";
 }
  
 /*
@@ -0,0 +1,160 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// SmallFunction<Sig, N>: a move-only replacement for std::function that stores
+// the callable inside the object (up to N bytes) and never allocates. A callable
+// that does not fit is a compile error, not a silent heap allocation.
+// A call is one indirect call through a stored function pointer; there is no
+// vtable, no RTTI (no target_type()/target()), and no copy.
+//
+// FunctionRef<Sig>: a non-owning reference to a callable, two pointers wide, for
+// parameters. Like std::string_view, it must not outlive what it refers to.
+
+template <typename Sig, size_t N = 2 * sizeof(void*)>
+class SmallFunction;
+
+template <typename R, typename... Args, size_t N>
+class SmallFunction<R(Args...), N>
+{
+public:
+    SmallFunction() = default;
+
+    template <typename F>
+        requires (!std::is_same_v<std::decay_t<F>, SmallFunction>) && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>
+    SmallFunction(F&& f)
+    {
+        using T = std::decay_t<F>; // functions decay to function pointers
+        static_assert(sizeof(T) <= N, "callable does not fit in this SmallFunction: increase N");
+        static_assert(alignof(T) <= alignof(void*), "over-aligned callables are not supported");
+        static_assert(std::is_nothrow_move_constructible_v<T>, "the callable must be nothrow movable");
+        ::new (static_cast<void*>(storage)) T(std::forward<F>(f));
+        invoker = [](void* s, Args&&... args) -> R {return std::invoke(*static_cast<T*>(s), std::forward<Args>(args)...);};
+        if constexpr (!std::is_trivially_copyable_v<T>) manager = &manage<T>;
+    }
+
+    SmallFunction(SmallFunction&& other) noexcept {take(other);}
+
+    SmallFunction& operator=(SmallFunction&& other) noexcept
+    {
+        if(this != &other)
+        {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    SmallFunction(const SmallFunction&) = delete;
+    SmallFunction& operator=(const SmallFunction&) = delete;
+
+    ~SmallFunction() {reset();}
+
+    explicit operator bool() const {return invoker != &empty;}
+
+    // Calling an empty SmallFunction throws std::bad_function_call, like std::function,
+    // without a null check on the call path: the empty state has its own invoker.
+    R operator()(Args... args) const {return invoker(storage, std::forward<Args>(args)...);}
+
+private:
+    enum class Op {Move, Destroy};
+
+    template <typename T>
+    static void manage(Op op, void* self, void* other)
+    {
+        if(op == Op::Move) ::new (self) T(std::move(*static_cast<T*>(other)));
+        static_cast<T*>(op == Op::Move ? other : self)->~T();
+    }
+
+    static R empty(void*, Args&&...) {throw std::bad_function_call();}
+
+    // Trivially copyable callables (function pointers, lambdas capturing pointers or
+    // numbers) have no manager: they are moved with memcpy and need no destructor.
+    void take(SmallFunction& other) noexcept
+    {
+        if(other.manager) other.manager(Op::Move, storage, other.storage);
+        else std::memcpy(storage, other.storage, N);
+        invoker = other.invoker;
+        manager = other.manager;
+        other.invoker = &empty;
+        other.manager = nullptr;
+    }
+
+    void reset() noexcept
+    {
+        if(manager) manager(Op::Destroy, storage, nullptr);
+        invoker = &empty;
+        manager = nullptr;
+    }
+
+    R (*invoker)(void*, Args&&...) = &empty;
+    void (*manager)(Op, void*, void*) = nullptr;
+    alignas(void*) mutable unsigned char storage[N]{}; // zeroed: a move copies all N bytes
+};
+
+template <typename Sig>
+class FunctionRef;
+
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)>
+{
+public:
+    template <typename F>
+        requires (!std::is_same_v<std::remove_cvref_t<F>, FunctionRef>) && std::is_invocable_r_v<R, F&, Args...>
+    FunctionRef(F&& f) noexcept
+    {
+        using T = std::remove_reference_t<F>;
+        if constexpr (std::is_function_v<T>)
+        {
+            // A function is not an object: keep its address in the function pointer member.
+            target.function = reinterpret_cast<void (*)()>(&f);
+            invoker = [](Target t, Args&&... args) -> R {
+                return reinterpret_cast<T*>(t.function)(std::forward<Args>(args)...);
+            };
+        }
+        else
+        {
+            target.object = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+            invoker = [](Target t, Args&&... args) -> R {
+                return std::invoke(*static_cast<T*>(t.object), std::forward<Args>(args)...);
+            };
+        }
+    }
+
+    R operator()(Args... args) const {return invoker(target, std::forward<Args>(args)...);}
+
+private:
+    union Target
+    {
+        void* object;
+        void (*function)();
+    };
+
+    Target target;
+    R (*invoker)(Target, Args&&...);
+};
+
+/*
+Why not std::function?
+    std::function has to accept any callable, so it heap-allocates those that do
+    not fit its small internal buffer (16 bytes in libstdc++), must be copyable
+    (copying may allocate again), and carries type information for target().
+    A strategy is set once and called many times; it needs none of that.
+
+Why a size parameter?
+    The buffer is part of every object that holds a SmallFunction, so it should
+    be as large as the callables actually used and no larger. The default (two
+    pointers) fits function pointers, empty functors and lambdas capturing one
+    or two pointers or numbers.
+
+Why a separate manager?
+    The call goes through `invoker` alone. Moving and destroying need a second
+    function, but only for callables that are not trivially copyable; for the
+    common cases (function pointers, captureless or trivially capturing lambdas)
+    it stays null and a move is a memcpy.
+*/
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "strategyclassicgc.h"
+
+// ClassicStrategyApproach as it was (a std::shared_ptr<HealthCalculator> in every
+// character) versus the flyweight registry (a plain pointer to a shared strategy).
+//   build            create n characters, strategies cycling over three kinds
+//   copy + destroy   each thread copies its share of the characters and drops the copies
+// usage: ./strategy_benchmark [characters] [threads]
+
+using Clock = std::chrono::steady_clock;
+
+// The original design, kept as the baseline.
+namespace SharedPtrStrategy
+{
+class GameCharacter;
+
+class HealthCalculator
+{
+public:
+    virtual int calc(const GameCharacter&) const {return 100;}
+    virtual ~HealthCalculator() = default;
+};
+
+class FastDecay : public HealthCalculator
+{
+    int calc(const GameCharacter&) const {return 50;}
+};
+
+class SlowDecay : public HealthCalculator
+{
+    int calc(const GameCharacter&) const {return 200;}
+};
+
+class GameCharacter
+{
+public:
+    explicit GameCharacter(std::shared_ptr<HealthCalculator> hc) : hCalc{std::move(hc)} {}
+    int healthValue() const {return hCalc->calc(*this);}
+private:
+    std::shared_ptr<HealthCalculator> hCalc;
+};
+} // namespace SharedPtrStrategy
+
+template <typename F>
+double ms(F&& f)
+{
+    auto t0 = Clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+template <typename Character>
+double copyAndDestroy(const std::vector<Character>& chars, unsigned threads)
+{
+    return ms([&]{
+        std::vector<std::thread> pool;
+        size_t share = chars.size() / threads;
+        for(unsigned t = 0; t < threads; ++t)
+        {
+            pool.emplace_back([&, t]{
+                auto first = chars.begin() + t * share;
+                auto last = t + 1 == threads ? chars.end() : first + share;
+                long long sink = 0;
+                for(int r = 0; r < 4; ++r) // copy in blocks, so the copies stay in cache
+                {
+                    std::vector<Character> copies;
+                    copies.reserve(4096);
+                    for(auto it = first; it != last; ++it)
+                    {
+                        copies.push_back(*it);
+                        if(copies.size() == 4096)
+                        {
+                            sink += copies.back().healthValue();
+                            copies.clear();
+                        }
+                    }
+                }
+                if(sink == 42) std::puts(""); // keep the work observable
+            });
+        }
+        for(auto& th : pool) th.join();
+    }) / 4;
+}
+
+template <typename Character, typename Make>
+void run(const char* name, size_t n, unsigned threads, Make&& make)
+{
+    std::vector<Character> chars;
+    chars.reserve(n);
+    double build = ms([&]{for(size_t i = 0; i < n; ++i) chars.push_back(make(i % 3));});
+    double copy = copyAndDestroy(chars, threads);
+    std::printf("%-40s %10.1f %16.1f\n", name, build, copy);
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    unsigned threads = argc > 2 ? std::atoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%zu characters, %u thread(s), times in ms\n\n", n, threads);
+    std::printf("%-40s %10s %16s\n", "", "build", "copy + destroy");
+
+    {
+        using namespace SharedPtrStrategy;
+        run<GameCharacter>("shared_ptr, one strategy per character", n, threads, [](int k){
+            if(k == 0) return GameCharacter(std::make_shared<HealthCalculator>());
+            if(k == 1) return GameCharacter(std::make_shared<FastDecay>());
+            return GameCharacter(std::make_shared<SlowDecay>());
+        });
+        std::shared_ptr<HealthCalculator> shared[] = {
+            std::make_shared<HealthCalculator>(), std::make_shared<FastDecay>(), std::make_shared<SlowDecay>()};
+        run<GameCharacter>("shared_ptr, three shared strategies", n, threads,
+                           [&](int k){return GameCharacter(shared[k]);});
+    }
+    {
+        using namespace ClassicStrategyApproach;
+        const HealthCalculator* flyweights[] = {
+            &StrategyRegistry::get<HealthCalculator>(), &StrategyRegistry::get<FastDecay>(), &StrategyRegistry::get<SlowDecay>()};
+        run<GameCharacter>("flyweight registry", n, threads, [&](int k){return GameCharacter(*flyweights[k]);});
+    }
+}
+
+/*
+What to expect:
+    build: one make_shared per character is an allocation each; the shared and
+    flyweight versions allocate nothing beyond the vector.
+    copy + destroy: every shared_ptr copy and destruction is an atomic increment
+    and decrement. With one strategy per character they are spread over n control
+    blocks, each a likely cache miss. With three shared strategies all threads
+    hammer the same three counters, and adding threads makes it slower. The
+    flyweight character is a pointer: copies are plain 8-byte stores.
+*/
@@ -1,5 +1,7 @@
+#include <atomic>
 #include <iostream>
-#include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace ClassicStrategyApproach
 {
@@ -22,13 +24,80 @@ class SlowDecay : public HealthCalculator
     int calc(const GameCharacter&) const {return 200;}
 };
 
+// Base of strategies that carry state. The reference count lives in the object
+// itself (intrusive), so an owning pointer is one pointer and one allocation.
+class StatefulHealthCalculator : public HealthCalculator
+{
+private:
+    template <typename T> friend class IntrusivePtr;
+    mutable std::atomic<int> refs{0};
+};
+
+template <typename T>
+class IntrusivePtr
+{
+public:
+    IntrusivePtr() = default;
+    explicit IntrusivePtr(T* p_) : p{p_} {retain();}
+    IntrusivePtr(const IntrusivePtr& other) : p{other.p} {retain();}
+    IntrusivePtr(IntrusivePtr&& other) noexcept : p{std::exchange(other.p, nullptr)} {}
+    IntrusivePtr& operator=(IntrusivePtr other) noexcept {std::swap(p, other.p); return *this;}
+    ~IntrusivePtr()
+    {
+        if(p && p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete p;
+    }
+    T* get() const {return p;}
+    T& operator*() const {return *p;}
+    T* operator->() const {return p;}
+private:
+    void retain() {if(p) p->refs.fetch_add(1, std::memory_order_relaxed);}
+    T* p{nullptr};
+};
+
+class ProportionalDecay : public StatefulHealthCalculator
+{
+public:
+    explicit ProportionalDecay(double rate_) : rate{rate_} {}
+    int calc(const GameCharacter&) const {return static_cast<int>(100 * (1.0 - rate));}
+private:
+    double rate;
+};
+
+// Flyweight registry: a stateless strategy exists once per program. get<FastDecay>()
+// returns the same immortal instance every time, so no character ever allocates or
+// owns one. Stateful strategies are created with make<...>(args) and owned through
+// IntrusivePtr by whoever configures them (a level, a faction, ...).
+class StrategyRegistry
+{
+public:
+    template <typename Strategy>
+        requires std::is_base_of_v<HealthCalculator, Strategy> && (!std::is_base_of_v<StatefulHealthCalculator, Strategy>)
+    static const Strategy& get()
+    {
+        static const Strategy* instance = new Strategy; // never deleted: valid until the very end of the program
+        return *instance;
+    }
+
+    template <typename Strategy, typename... Args>
+        requires std::is_base_of_v<StatefulHealthCalculator, Strategy>
+    static IntrusivePtr<Strategy> make(Args&&... args)
+    {
+        return IntrusivePtr<Strategy>(new Strategy(std::forward<Args>(args)...));
+    }
+};
+
+// Holds a plain, non-owning pointer to its strategy: copying or destroying a
+// character touches no reference count. The strategy must outlive the character,
+// which immortal flyweights do by construction; for a stateful one, keep its
+// IntrusivePtr alive for as long as characters use it.
 class GameCharacter
 {
 public:
-    explicit GameCharacter(std::shared_ptr<HealthCalculator> hc) : hCalc{std::move(hc)} {}
+    explicit GameCharacter(const HealthCalculator& hc) : hCalc{&hc} {}
+    GameCharacter(const HealthCalculator&&) = delete; // a temporary would be gone before the first call
     int healthValue() const {return hCalc->calc(*this);}
 private:
-    std::shared_ptr<HealthCalculator> hCalc;
+    const HealthCalculator* hCalc;
 };
 
 
@@ -39,6 +108,14 @@ Advantages:
   - Fully OO: each strategy can be extended via inheritance.
   - Common in design-pattern implementations.
 Drawbacks:
-  - More boilerplate (extra classes, heap allocation).
+  - More boilerplate (extra classes).
   - Still uses virtual dispatch indirectly.
-*/
\ No newline at end of file
+
+Why not std::shared_ptr<HealthCalculator> per character?
+  It was the original design here. Every character allocated its own strategy
+  (make_shared), and every copy or destruction of a character was an atomic
+  increment or decrement. When the characters share a strategy, that count is
+  one cache line written by every thread. Stateless strategies never needed
+  more than one instance, and the lifetime of the stateful ones is a property of
+  whoever configures them, not of each character.
+*/
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <functional>
+#include "smallfunction.h"
 
 
 namespace StratFunApproach
@@ -8,9 +9,11 @@ namespace StratFunApproach
 class GameCharacter
 {
 public:
-    using HealthFunction = std::function<int(const GameCharacter&)>;
+    using HealthFunction = SmallFunction<int(const GameCharacter&)>; // inline, never allocates; move-only
     explicit GameCharacter(HealthFunction hf = defaultHealthCalc) : healthCalc{std::move(hf)} {}
     int healthValue() const {return healthCalc(*this);}
+    // "What if": the health under another calculation, which is only borrowed.
+    int healthValue(FunctionRef<int(const GameCharacter&)> calc) const {return calc(*this);}
 private:
     HealthFunction healthCalc;
     static int defaultHealthCalc(const GameCharacter&){return 100;}
@@ -33,4 +36,6 @@ Advantages:
   - Very clean and modern (C++11+).
 Drawbacks:
   - External functions can’t access private members unless made friends.
+  - std::function may heap-allocate the callable and is copyable; HealthFunction
+    is a SmallFunction instead (smallfunction.h), which makes GameCharacter move-only.
 */
\ No newline at end of file
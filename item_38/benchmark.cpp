@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "concat.h"
+
+// Chained operator+ versus concat() for the strings built in this directory:
+// Address::full() (three short pieces) and a log line mixing text and numbers.
+// The address pieces are long enough to defeat std::string's SSO, as real ones are.
+
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+double nsPerOp(size_t n, F&& build)
+{
+    size_t sink = 0;
+    auto t0 = Clock::now();
+    for(size_t i = 0; i < n; ++i) sink += build(i).size();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / n;
+    if(sink == 42) std::puts(""); // keep the work observable
+    return ns;
+}
+
+int main()
+{
+    constexpr size_t N = 5'000'000;
+    const std::vector<std::string> streets{"42 Maple Street, Apartment 7", "1600 Pennsylvania Avenue NW"};
+    const std::vector<std::string> cities{"Springfield, Illinois", "Washington, District of Columbia"};
+
+    double plus = nsPerOp(N, [&](size_t i){return streets[i & 1] + ", " + cities[i & 1];});
+    double cat = nsPerOp(N, [&](size_t i){return concat(streets[i & 1], ", ", cities[i & 1]);});
+    std::printf("address   operator+ %6.1f ns   concat %6.1f ns\n", plus, cat);
+
+    plus = nsPerOp(N, [&](size_t i){
+        return "Logging Buy Transaction: " + std::to_string(i) + " shares of " + streets[i & 1]
+               + " @ " + std::to_string(101.25 + i % 7) + " in " + cities[i & 1];
+    });
+    cat = nsPerOp(N, [&](size_t i){
+        return concat("Logging Buy Transaction: ", i, " shares of ", streets[i & 1],
+                      " @ ", 101.25 + i % 7, " in ", cities[i & 1]);
+    });
+    std::printf("log line  operator+ %6.1f ns   concat %6.1f ns\n", plus, cat);
+
+    std::string line; // reused buffer: allocates only until it reaches its largest size
+    cat = nsPerOp(N, [&](size_t i) -> const std::string& {
+        line.clear();
+        appendTo(line, "Logging Buy Transaction: ", i, " shares of ", streets[i & 1],
+                 " @ ", 101.25 + i % 7, " in ", cities[i & 1]);
+        return line;
+    });
+    std::printf("log line  appendTo into a reused buffer %6.1f ns\n", cat);
+}
+
+/*
+What to expect:
+    operator+ on the address allocates twice: street + ", " creates a temporary
+    and appending city to it usually has to grow it. concat allocates once.
+    The log line is worse for operator+: each std::to_string is its own string,
+    and the result is regrown several times. concat formats the numbers with
+    to_chars on the stack and allocates once; appending into a reused buffer
+    does not allocate at all.
+    Note that std::to_string(double) prints "101.250000" while to_chars prints the
+    shortest exact form, "101.25".
+*/
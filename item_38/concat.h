@@ -0,0 +1,88 @@
+#pragma once
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// concat(a, b, c, ...) builds a std::string from any mix of std::string,
+// std::string_view, string literals, chars and numbers with exactly one allocation:
+// it first works out the total length, reserves it, then writes each piece once.
+//
+//     std::string s = concat(street, ", ", city);
+//     std::string log = concat("Buy ", quantity, " @ ", price);
+//
+// appendTo(out, ...) does the same at the end of an existing string, so a buffer
+// that is reused across calls (e.g. a log line) stops allocating once it is big enough.
+//
+// Compare with street + ", " + city: every + produces a new temporary std::string,
+// and each one may reallocate as it grows.
+
+namespace concat_detail
+{
+
+// One argument, viewed as characters. Numbers are formatted into the piece's own
+// buffer with std::to_chars (no locale, no allocation), so the length is known
+// before anything is written. A Piece points into itself and is never copied.
+class Piece
+{
+public:
+    Piece(std::string_view s) : text{s} {}
+    Piece(const std::string& s) : text{s} {}
+    Piece(const char* s) : text{s} {}
+    Piece(char c) : buffer{c}, text{buffer, 1} {}
+
+    template <typename T>
+        requires (std::integral<T> || std::floating_point<T>) && (!std::same_as<T, char>) && (!std::same_as<T, bool>)
+    Piece(T value)
+    {
+        auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        text = {buffer, static_cast<size_t>(end - buffer)};
+    }
+
+    Piece(const Piece&) = delete;
+    Piece& operator=(const Piece&) = delete;
+
+    std::string_view view() const {return text;}
+
+private:
+    char buffer[32]; // enough for any integer and the shortest form of any double
+    std::string_view text;
+};
+
+} // namespace concat_detail
+
+template <typename... Args>
+    requires (sizeof...(Args) > 0)
+void appendTo(std::string& out, const Args&... args)
+{
+    // Guaranteed copy elision: each Piece is constructed in place in the array.
+    const concat_detail::Piece pieces[] = {concat_detail::Piece(args)...};
+    size_t total = out.size();
+    for(const auto& p : pieces) total += p.view().size();
+    if(total > out.capacity())
+    {
+        // A piece may view `out` itself (appendTo(s, "-", s)): growing `out` in place
+        // would free what it points to. Build into a new string and swap it in.
+        std::string grown;
+        grown.reserve(total);
+        grown.append(out);
+        for(const auto& p : pieces) grown.append(p.view());
+        out.swap(grown);
+    }
+    else
+    {
+        // No reallocation: the characters already in `out` stay where they are,
+        // so pieces viewing them remain valid while we write past the end.
+        for(const auto& p : pieces) out.append(p.view());
+    }
+}
+
+template <typename... Args>
+    requires (sizeof...(Args) > 0)
+std::string concat(const Args&... args)
+{
+    std::string out;
+    appendTo(out, args...);
+    return out;
+}
@@ -2,12 +2,13 @@
 #include <list>
 #include <algorithm>
 #include <string>
+#include "concat.h"
 
 class Address
 {
 public:
     Address(std::string street_, std::string city_) : street{std::move(street_)}, city{std::move(city_)} {}
-    std::string full() const { return street + ", " + city;}
+    std::string full() const { return concat(street, ", ", city);} // one allocation, no temporaries
 private:
     std::string street;
     std::string city;
@@ -17,7 +18,7 @@ private:
 class PhoneNumber {
 public:
     PhoneNumber(std::string number_) : number(std::move(number_)) {}
-    std::string str() const { return number; }
+    const std::string& str() const { return number; }
 private:
     std::string number;
 };
@@ -31,8 +32,9 @@ public:
                                                                      address{std::move(address_)},
                                                                      phone{std::move(phone_)} {}
     void printInfo() const {
-        std::cout << name << " lives at " << address.full()
-                  << " and can be reached at " << phone.str() << "\n";
+        std::string line = concat(name, " lives at ", address.full(),
+                                  " and can be reached at ", phone.str(), "\n");
+        std::cout << line;
     }
 private:
     std::string name; // Person *has-a* name.
@@ -106,6 +108,9 @@ int main() {
                  Address("42 Maple St", "Springfield"),
                  PhoneNumber("555-1234"));
     alice.printInfo();
+    std::string twice = "Springfield, 42 Maple St";
+    appendTo(twice, " / ", twice); // an argument may be the string being appended to
+    std::cout << twice << "\n";
 
     std::cout << "\n=== Example 2: 'is-implemented-in-terms-of' Relationship ===\n";
     BadSet<int> bad;
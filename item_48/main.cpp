@@ -1,8 +1,12 @@
+#include <cstdint>
 #include <iostream>
+#include "tables.h"
 
 template <uint64_t N>
 struct Factorial
 {
+    // unsigned arithmetic wraps silently, also at compile time: refuse N > 20
+    static_assert(Factorial<N-1>::value <= UINT64_MAX / N, "Factorial<N> overflows uint64_t");
     static constexpr uint64_t value = N * Factorial<N-1>::value;
 };
 
@@ -57,6 +61,9 @@ void fastAdd(T* a, T* b)
 int main()
 {
     std::cout << "Factorial<20>::value = " << Factorial<20>::value << "\n"; // compile time recursive calculation with template metaprogramming (TMP)
+    // the same values as a table built by one constexpr loop (see tables.h), and further with wider integers
+    std::cout << "Factorials<uint64_t, 21>[20] = " << tables::Factorials<uint64_t, 21>[20] << "\n";
+    std::cout << "Factorials<WideUInt<4>, 58>[57] = " << tables::toString(tables::Factorials<tables::WideUInt<4>, 58>[57]) << "\n";
     
 
     int i1[2] = {1, 2};
@@ -110,7 +117,7 @@ TEMPLATE METAPROGRAMMING (TMP)
  3. PRACTICAL EXAMPLES:
  - Dimensional Analysis: Ensuring mass and velocity are never added together.
  - Expression Templates: Optimizing matrix math by eliminating temporary 
-   objects and merging loops (e.g., m1 * m2 * m3).
+   objects and merging loops (e.g., m1 * m2 * m3). See vec.h for vectors.
  - Policy-Based Design: Generating hundreds of custom class variants (like 
    smart pointers) from a few policy templates.
 
@@ -0,0 +1,339 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "simdkernels.h"
+
+// Row-major matrices and their product.
+//
+//     Matrix<double, 3, 4> a;                      // sizes in the type: a * b only compiles
+//     Matrix<double, 4, 2> b;                      // if the inner dimensions agree
+//     Matrix<double, 3, 2> c = a * b;
+//
+//     DynMatrix<double> d(1000, 300), e(300, 17);  // sizes at runtime; a mismatch throws
+//     DynMatrix<double> f = d * e;
+//
+//     auto g = multiplyChain(m1, m2, m3, m4);      // m1 * m2 * m3 * m4, in the cheapest order
+//
+// Both types multiply with the same cache-blocked kernel (below). A Matrix keeps
+// its elements inside the object, so it suits small and medium sizes; a large
+// one on the stack will overflow it. Use DynMatrix for those.
+
+namespace matrix_detail
+{
+
+// The product C += A * B is computed in blocks sized for the caches:
+//   - a KC x NC block of B is copied ("packed") into panels of NR columns, so the
+//     innermost loop reads B sequentially; one panel (KC x NR) stays in L1,
+//   - an MC x KC block of A is reused against every panel and stays in L2,
+//   - the micro-kernel computes an MR x NR block of C in registers: per step of
+//     k it loads one row of the panel (two vectors) and one element from each of
+//     the MR rows of A, and does 2 * MR vector multiply-adds.
+template <typename T> inline constexpr size_t Lanes = simd::VectorBytes / sizeof(T);
+template <typename T> inline constexpr size_t NR = 2 * Lanes<T>;
+inline constexpr size_t MR = 6; // 12 accumulators + 2 B vectors + 1 broadcast fit 16 registers
+template <typename T> inline constexpr size_t KC = 16384 / (NR<T> * sizeof(T)); // 16 KiB panel
+inline constexpr size_t MC = 120;
+inline constexpr size_t NC = 1024;
+
+// Below this many multiply-adds the packing costs more than it saves.
+inline constexpr size_t SmallProduct = 32 * 32 * 32;
+
+template <typename T>
+void multiplySimple(const T* a, const T* b, T* c, size_t M, size_t K, size_t N)
+{
+    // i-k-j: the inner loop runs along rows of B and C, contiguous and vectorisable
+    for(size_t i = 0; i < M; ++i)
+        for(size_t k = 0; k < K; ++k)
+        {
+            T aik = a[i * K + k];
+            for(size_t j = 0; j < N; ++j) c[i * N + j] += aik * b[k * N + j];
+        }
+}
+
+// B[0..kc)[0..nc) (row stride ldb) into panels of NR columns, each kc rows of NR
+// contiguous elements; the last panel is padded with zeros.
+template <typename T>
+void packB(const T* b, size_t ldb, size_t kc, size_t nc, T* out)
+{
+    for(size_t j0 = 0; j0 < nc; j0 += NR<T>)
+    {
+        size_t width = std::min(NR<T>, nc - j0);
+        for(size_t p = 0; p < kc; ++p)
+        {
+            const T* row = b + p * ldb + j0;
+            for(size_t j = 0; j < NR<T>; ++j) *out++ = j < width ? row[j] : T{};
+        }
+    }
+}
+
+// C[0..Rows)[0..cols) += A[0..Rows)[0..kc) * panel, cols <= NR.
+template <size_t Rows, typename T>
+void microKernel(size_t kc, const T* a, size_t lda, const T* panel, T* c, size_t ldc, size_t cols)
+{
+    using V = simd::detail::Vec<T>;
+    constexpr size_t L = Lanes<T>;
+    V acc[Rows][2];
+    for(size_t r = 0; r < Rows; ++r) acc[r][0] = acc[r][1] = V{};
+    for(size_t p = 0; p < kc; ++p)
+    {
+        V b0 = simd::detail::load(panel + p * 2 * L);
+        V b1 = simd::detail::load(panel + p * 2 * L + L);
+        for(size_t r = 0; r < Rows; ++r)
+        {
+            T ar = a[r * lda + p];
+            acc[r][0] += ar * b0;
+            acc[r][1] += ar * b1;
+        }
+    }
+    for(size_t r = 0; r < Rows; ++r)
+    {
+        T* row = c + r * ldc;
+        if(cols == 2 * L)
+        {
+            simd::detail::store(row, simd::detail::load(row) + acc[r][0]);
+            simd::detail::store(row + L, simd::detail::load(row + L) + acc[r][1]);
+        }
+        else
+        {
+            T partial[2 * L];
+            simd::detail::store(partial, acc[r][0]);
+            simd::detail::store(partial + L, acc[r][1]);
+            for(size_t j = 0; j < cols; ++j) row[j] += partial[j];
+        }
+    }
+}
+
+template <typename T, size_t... Rows>
+void microKernelRows(size_t rows, std::index_sequence<Rows...>, size_t kc, const T* a, size_t lda,
+                     const T* panel, T* c, size_t ldc, size_t cols)
+{
+    ((rows == Rows + 1 ? microKernel<Rows + 1>(kc, a, lda, panel, c, ldc, cols) : void()), ...);
+}
+
+// C += A * B, all row-major: A is M x K, B is K x N, C is M x N.
+template <typename T>
+void multiply(const T* a, const T* b, T* c, size_t M, size_t K, size_t N)
+{
+    if constexpr (!simd::Element<T>) return multiplySimple(a, b, c, M, K, N);
+    else
+    {
+        if(M * K * N <= SmallProduct) return multiplySimple(a, b, c, M, K, N);
+        std::vector<T> packed(KC<T> * ((std::min(N, NC) + NR<T> - 1) / NR<T>) * NR<T>);
+        for(size_t jc = 0; jc < N; jc += NC)
+        {
+            size_t nc = std::min(NC, N - jc);
+            for(size_t pc = 0; pc < K; pc += KC<T>)
+            {
+                size_t kc = std::min(KC<T>, K - pc);
+                packB(b + pc * N + jc, N, kc, nc, packed.data());
+                for(size_t ic = 0; ic < M; ic += MC)
+                {
+                    size_t mc = std::min(MC, M - ic);
+                    for(size_t jr = 0; jr < nc; jr += NR<T>)
+                    {
+                        const T* panel = packed.data() + jr * kc;
+                        size_t cols = std::min(NR<T>, nc - jr);
+                        for(size_t ir = 0; ir < mc; ir += MR)
+                        {
+                            const T* ablock = a + (ic + ir) * K + pc;
+                            T* cblock = c + (ic + ir) * N + jc + jr;
+                            size_t rows = std::min(MR, mc - ir);
+                            if(rows == MR) microKernel<MR>(kc, ablock, K, panel, cblock, N, cols);
+                            else microKernelRows(rows, std::make_index_sequence<MR - 1>{}, kc, ablock, K,
+                                                 panel, cblock, N, cols);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace matrix_detail
+
+template <typename T, size_t R, size_t C>
+class Matrix
+{
+public:
+    static constexpr size_t Rows = R;
+    static constexpr size_t Cols = C;
+
+    Matrix() = default; // zeros
+    Matrix(std::initializer_list<std::initializer_list<T>> rows)
+    {
+        if(rows.size() != R) throw std::invalid_argument("Matrix: wrong number of rows");
+        size_t i = 0;
+        for(const auto& row : rows)
+        {
+            if(row.size() != C) throw std::invalid_argument("Matrix: wrong number of columns");
+            std::copy(row.begin(), row.end(), elements.begin() + i++ * C);
+        }
+    }
+
+    static Matrix identity() requires (R == C)
+    {
+        Matrix m;
+        for(size_t i = 0; i < R; ++i) m(i, i) = T{1};
+        return m;
+    }
+
+    T& operator()(size_t i, size_t j) {return elements[i * C + j];}
+    const T& operator()(size_t i, size_t j) const {return elements[i * C + j];}
+    constexpr size_t rows() const {return R;}
+    constexpr size_t cols() const {return C;}
+    T* data() {return elements.data();}
+    const T* data() const {return elements.data();}
+
+private:
+    std::array<T, R * C> elements{};
+};
+
+template <typename T, size_t R, size_t K, size_t C>
+Matrix<T, R, C> operator*(const Matrix<T, R, K>& a, const Matrix<T, K, C>& b)
+{
+    Matrix<T, R, C> c;
+    matrix_detail::multiply(a.data(), b.data(), c.data(), R, K, C);
+    return c;
+}
+
+template <typename T>
+class DynMatrix
+{
+public:
+    DynMatrix() = default;
+    DynMatrix(size_t rows, size_t cols, T value = T{}) : nRows{rows}, nCols{cols}, elements(rows * cols, value) {}
+
+    T& operator()(size_t i, size_t j) {return elements[i * nCols + j];}
+    const T& operator()(size_t i, size_t j) const {return elements[i * nCols + j];}
+    size_t rows() const {return nRows;}
+    size_t cols() const {return nCols;}
+    T* data() {return elements.data();}
+    const T* data() const {return elements.data();}
+
+private:
+    size_t nRows{0};
+    size_t nCols{0};
+    std::vector<T> elements;
+};
+
+template <typename T>
+DynMatrix<T> operator*(const DynMatrix<T>& a, const DynMatrix<T>& b)
+{
+    if(a.cols() != b.rows()) throw std::invalid_argument("DynMatrix: inner dimensions differ");
+    DynMatrix<T> c(a.rows(), b.cols());
+    matrix_detail::multiply(a.data(), b.data(), c.data(), a.rows(), a.cols(), b.cols());
+    return c;
+}
+
+// ---- matrix chains ------------------------------------------------------------
+// (m1 * m2) * m3 and m1 * (m2 * m3) give the same matrix at very different costs:
+// for 10x100, 100x5 and 5x50 matrices the first takes 7500 multiply-adds, the
+// second 75000. With all sizes in the types, the cheapest order is found by the
+// compiler, by the classic dynamic programme over sub-chains.
+
+// Matrix i of the chain is dims[i] x dims[i+1].
+template <size_t N>
+struct ChainPlan
+{
+    std::array<std::array<uint64_t, N>, N> cost{}; // multiply-adds for matrices i..j
+    std::array<std::array<size_t, N>, N> split{};  // (i..k) * (k+1..j) is the cheapest
+};
+
+template <size_t N>
+constexpr ChainPlan<N> planChain(const std::array<size_t, N + 1>& dims)
+{
+    ChainPlan<N> plan;
+    for(size_t length = 2; length <= N; ++length)
+        for(size_t i = 0; i + length <= N; ++i)
+        {
+            size_t j = i + length - 1;
+            plan.cost[i][j] = std::numeric_limits<uint64_t>::max();
+            for(size_t k = i; k < j; ++k)
+            {
+                uint64_t cost = plan.cost[i][k] + plan.cost[k+1][j] + uint64_t(dims[i]) * dims[k+1] * dims[j+1];
+                if(cost < plan.cost[i][j])
+                {
+                    plan.cost[i][j] = cost;
+                    plan.split[i][j] = k;
+                }
+            }
+        }
+    return plan;
+}
+
+// The cost of multiplying left to right, ((m1 * m2) * m3) * ..., for comparison.
+template <size_t N>
+constexpr uint64_t leftToRightCost(const std::array<size_t, N + 1>& dims)
+{
+    uint64_t cost = 0;
+    for(size_t i = 1; i < N; ++i) cost += uint64_t(dims[0]) * dims[i] * dims[i+1];
+    return cost;
+}
+
+namespace matrix_detail
+{
+
+template <typename... Ms>
+inline constexpr std::array<size_t, sizeof...(Ms) + 1> chainDims = [] {
+    constexpr std::array<size_t, sizeof...(Ms)> rows{Ms::Rows...};
+    constexpr std::array<size_t, sizeof...(Ms)> cols{Ms::Cols...};
+    std::array<size_t, sizeof...(Ms) + 1> d{};
+    for(size_t i = 0; i < sizeof...(Ms); ++i) d[i] = rows[i];
+    d[sizeof...(Ms)] = cols[sizeof...(Ms) - 1];
+    return d;
+}();
+
+// Matrices I..J of the chain; a single matrix is returned by reference, not copied.
+template <size_t I, size_t J, const auto& Plan, typename Tuple>
+decltype(auto) multiplyRange(const Tuple& ms)
+{
+    if constexpr (I == J) return std::get<I>(ms);
+    else
+    {
+        constexpr size_t K = Plan.split[I][J];
+        return multiplyRange<I, K, Plan>(ms) * multiplyRange<K + 1, J, Plan>(ms);
+    }
+}
+
+template <typename... Ms>
+inline constexpr auto chainPlan = planChain<sizeof...(Ms)>(chainDims<Ms...>);
+
+} // namespace matrix_detail
+
+// m1 * m2 * ... * mn, parenthesised for the fewest multiply-adds.
+template <typename T, size_t R, size_t C, typename... Ms>
+auto multiplyChain(const Matrix<T, R, C>& first, const Ms&... rest)
+{
+    return matrix_detail::multiplyRange<0, sizeof...(Ms), matrix_detail::chainPlan<Matrix<T, R, C>, Ms...>>(
+        std::forward_as_tuple(first, rest...));
+}
+
+/*
+Why not the textbook triple loop?
+    for i, for j, for k: c[i][j] += a[i][k] * b[k][j] walks down a column of B
+    in the inner loop: one element per cache line, and for large N a cache miss
+    per multiply-add. Each element of A and B is used N times, but by the time it
+    is needed again it has been evicted. Blocking reorders the same arithmetic so
+    that a block is used many times while it is in cache, and the micro-kernel
+    keeps a block of C in registers so that the inner loop does nothing but load
+    and multiply-add.
+
+Why pack B?
+    Packing copies each block of B once into the exact order the micro-kernel
+    reads it: sequential, aligned to the panel width, padded at the edge so the
+    kernel never needs a partial vector load. The copy is O(K * N) work per block
+    against O(M * K * N) for the multiply.
+
+Fixed and dynamic sizes:
+    Both call the same kernel. With sizes in the type the compiler can resolve
+    the blocking loops for small matrices (which take the simple path) and
+    unroll them; a size mismatch is a compile error instead of an exception.
+*/
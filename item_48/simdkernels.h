@@ -0,0 +1,332 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+// Vector kernels for float, double, int32_t and int64_t: the general version of
+// fastAdd<T, N>. Every kernel comes in two forms:
+//
+//     simd::add(a, b, out, n);   // runtime length: SIMD main loop + scalar tail
+//     simd::add<8>(a, b, out);   // compile-time length: fully unrolled for small N
+//
+// Elementwise:  add, sub, mul (out = a op b), fma (out = a * b + c),
+//               axpy (y += alpha * x), scale (x *= alpha),
+//               ramp (out = max(alpha * x + beta, 0))
+// Reductions:   dot, sum, min, max
+//
+// The SIMD code uses the GCC/Clang vector extensions rather than intrinsics, so one
+// implementation compiles to SSE2, AVX/AVX2, AVX-512 or NEON, whichever the target
+// has: the vector width follows the -m/-march flags. `out` may be the same array
+// as an input (as in fastAdd, which adds in place), but must not partially overlap.
+
+namespace simd
+{
+
+template <typename T>
+concept Element = std::is_same_v<T, float> || std::is_same_v<T, double>
+               || std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>;
+
+#if defined(__AVX512F__)
+inline constexpr size_t VectorBytes = 64;
+#elif defined(__AVX__)
+inline constexpr size_t VectorBytes = 32;
+#else
+inline constexpr size_t VectorBytes = 16; // SSE2 / NEON
+#endif
+
+// Up to this many elements, the compile-time forms are unrolled into straight-line
+// code (which the compiler then packs into vector instructions); above it they
+// call the runtime-length loop with a constant n.
+inline constexpr size_t UnrollLimit = 64;
+
+namespace detail
+{
+
+template <typename T>
+struct VectorOf
+{
+    typedef T type __attribute__((vector_size(VectorBytes)));
+};
+
+template <typename T>
+using Vec = typename VectorOf<T>::type;
+
+template <typename T>
+inline constexpr size_t Lanes = VectorBytes / sizeof(T);
+
+// memcpy to and from a vector register: unaligned loads/stores, no aliasing UB.
+template <typename T>
+[[gnu::always_inline]] inline Vec<T> load(const T* p)
+{
+    Vec<T> v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+template <typename T>
+[[gnu::always_inline]] inline void store(T* p, Vec<T> v)
+{
+    std::memcpy(p, &v, sizeof(v));
+}
+
+// `op` is a generic lambda, applied to whole vectors in the main loop and to single
+// elements in the tail. Two vectors per iteration keep both load ports busy.
+template <typename T, typename Op>
+[[gnu::always_inline]] inline void map(const T* a, const T* b, T* out, size_t n, Op op)
+{
+    constexpr size_t L = Lanes<T>;
+    size_t i = 0;
+    for(; i + 2 * L <= n; i += 2 * L)
+    {
+        Vec<T> r0 = op(load(a + i), load(b + i));
+        Vec<T> r1 = op(load(a + i + L), load(b + i + L));
+        store(out + i, r0);
+        store(out + i + L, r1);
+    }
+    for(; i + L <= n; i += L) store(out + i, op(load(a + i), load(b + i)));
+    for(; i < n; ++i) out[i] = op(a[i], b[i]);
+}
+
+template <typename T, typename Op>
+[[gnu::always_inline]] inline void map(const T* a, const T* b, const T* c, T* out, size_t n, Op op)
+{
+    constexpr size_t L = Lanes<T>;
+    size_t i = 0;
+    for(; i + L <= n; i += L) store(out + i, op(load(a + i), load(b + i), load(c + i)));
+    for(; i < n; ++i) out[i] = op(a[i], b[i], c[i]);
+}
+
+// Four independent accumulators: a single one would make every iteration wait for
+// the previous add (3-4 cycles of latency), leaving the SIMD units mostly idle.
+// vectorAt(i) loads elements i .. i+Lanes-1 as a vector, scalarAt(i) element i.
+template <typename T, typename VectorAt, typename ScalarAt, typename Combine>
+[[gnu::always_inline]] inline T reduce(size_t n, T identity, VectorAt vectorAt, ScalarAt scalarAt, Combine combine)
+{
+    constexpr size_t L = Lanes<T>;
+    Vec<T> acc[4];
+    for(Vec<T>& v : acc) v = Vec<T>{} + identity;
+    size_t i = 0;
+    for(; i + 4 * L <= n; i += 4 * L)
+    {
+        for(size_t k = 0; k < 4; ++k) acc[k] = combine(acc[k], vectorAt(i + k * L));
+    }
+    for(; i + L <= n; i += L) acc[0] = combine(acc[0], vectorAt(i));
+    Vec<T> v = combine(combine(acc[0], acc[1]), combine(acc[2], acc[3]));
+    T result = identity;
+    for(size_t k = 0; k < L; ++k) result = combine(result, v[k]);
+    for(; i < n; ++i) result = combine(result, scalarAt(i));
+    return result;
+}
+
+template <size_t N, typename F>
+[[gnu::always_inline]] inline void unroll(F f)
+{
+    [&]<size_t... I>(std::index_sequence<I...>) {(f(I), ...);}(std::make_index_sequence<N>{});
+}
+
+inline constexpr auto Add = [](auto x, auto y) {return x + y;};
+inline constexpr auto Sub = [](auto x, auto y) {return x - y;};
+inline constexpr auto Mul = [](auto x, auto y) {return x * y;};
+inline constexpr auto Min = [](auto x, auto y) {return x < y ? x : y;}; // elementwise on vectors too
+inline constexpr auto Max = [](auto x, auto y) {return x > y ? x : y;};
+
+} // namespace detail
+
+// ---- runtime length ---------------------------------------------------------
+
+template <Element T> void add(const T* a, const T* b, T* out, size_t n) {detail::map(a, b, out, n, detail::Add);}
+template <Element T> void sub(const T* a, const T* b, T* out, size_t n) {detail::map(a, b, out, n, detail::Sub);}
+template <Element T> void mul(const T* a, const T* b, T* out, size_t n) {detail::map(a, b, out, n, detail::Mul);}
+
+// out = a * b + c. For floating point this is a multiply and an add (two roundings)
+// unless the compiler is allowed to contract it (-ffp-contract=fast, the default
+// with -std=gnu++20) and the target has FMA instructions.
+template <Element T>
+void fma(const T* a, const T* b, const T* c, T* out, size_t n)
+{
+    detail::map(a, b, c, out, n, [](auto x, auto y, auto z) {return x * y + z;});
+}
+
+// y += alpha * x
+template <Element T>
+void axpy(T alpha, const T* x, T* y, size_t n)
+{
+    detail::map(x, y, y, n, [alpha](auto xi, auto yi) {return alpha * xi + yi;});
+}
+
+// x *= alpha
+template <Element T>
+void scale(T alpha, T* x, size_t n)
+{
+    detail::map(x, x, x, n, [alpha](auto xi, auto) {return alpha * xi;});
+}
+
+// out = max(alpha * x + beta, 0): with alpha = 1, beta = -K the payoff of a call
+// struck at K, with alpha = -1, beta = K that of a put.
+template <Element T>
+void ramp(T alpha, T beta, const T* x, T* out, size_t n)
+{
+    detail::map(x, x, out, n, [alpha, beta](auto xi, auto) {
+        auto y = alpha * xi + beta;
+        return detail::Max(y, decltype(y){} + T{0});
+    });
+}
+
+// Reductions accumulate in several lanes and combine them at the end. For float
+// and double that is a different order of additions than a plain loop, so the
+// last bits of the result can differ from it (usually in the direction of more
+// accuracy, since each partial sum is smaller).
+template <Element T>
+T dot(const T* a, const T* b, size_t n)
+{
+    return detail::reduce<T>(n, T{0}, [=](size_t i) {return detail::load(a + i) * detail::load(b + i);},
+                             [=](size_t i) {return a[i] * b[i];}, detail::Add);
+}
+
+template <Element T>
+T sum(const T* a, size_t n)
+{
+    return detail::reduce<T>(n, T{0}, [=](size_t i) {return detail::load(a + i);},
+                             [=](size_t i) {return a[i];}, detail::Add);
+}
+
+// The smallest element; numeric_limits<T>::max() for n == 0. NaNs are not ordered.
+template <Element T>
+T min(const T* a, size_t n)
+{
+    return detail::reduce<T>(n, std::numeric_limits<T>::max(), [=](size_t i) {return detail::load(a + i);},
+                             [=](size_t i) {return a[i];}, detail::Min);
+}
+
+// The largest element; numeric_limits<T>::lowest() for n == 0.
+template <Element T>
+T max(const T* a, size_t n)
+{
+    return detail::reduce<T>(n, std::numeric_limits<T>::lowest(), [=](size_t i) {return detail::load(a + i);},
+                             [=](size_t i) {return a[i];}, detail::Max);
+}
+
+// ---- compile-time length ----------------------------------------------------
+// fastAdd<T, N> generalised: a fold over an index_sequence instead of recursion,
+// so there is no instantiation per element and no template depth limit.
+
+template <size_t N, Element T>
+void add(const T* a, const T* b, T* out)
+{
+    if constexpr (N <= UnrollLimit) detail::unroll<N>([&](size_t i) {out[i] = a[i] + b[i];});
+    else add(a, b, out, N);
+}
+
+template <size_t N, Element T>
+void sub(const T* a, const T* b, T* out)
+{
+    if constexpr (N <= UnrollLimit) detail::unroll<N>([&](size_t i) {out[i] = a[i] - b[i];});
+    else sub(a, b, out, N);
+}
+
+template <size_t N, Element T>
+void mul(const T* a, const T* b, T* out)
+{
+    if constexpr (N <= UnrollLimit) detail::unroll<N>([&](size_t i) {out[i] = a[i] * b[i];});
+    else mul(a, b, out, N);
+}
+
+template <size_t N, Element T>
+void fma(const T* a, const T* b, const T* c, T* out)
+{
+    if constexpr (N <= UnrollLimit) detail::unroll<N>([&](size_t i) {out[i] = a[i] * b[i] + c[i];});
+    else fma(a, b, c, out, N);
+}
+
+template <size_t N, Element T>
+void axpy(T alpha, const T* x, T* y)
+{
+    if constexpr (N <= UnrollLimit) detail::unroll<N>([&](size_t i) {y[i] += alpha * x[i];});
+    else axpy(alpha, x, y, N);
+}
+
+template <size_t N, Element T>
+void scale(T alpha, T* x)
+{
+    if constexpr (N <= UnrollLimit) detail::unroll<N>([&](size_t i) {x[i] *= alpha;});
+    else scale(alpha, x, N);
+}
+
+template <size_t N, Element T>
+void ramp(T alpha, T beta, const T* x, T* out)
+{
+    if constexpr (N <= UnrollLimit) detail::unroll<N>([&](size_t i) {out[i] = std::max(alpha * x[i] + beta, T{0});});
+    else ramp(alpha, beta, x, out, N);
+}
+
+template <size_t N, Element T>
+T dot(const T* a, const T* b)
+{
+    if constexpr (N <= UnrollLimit)
+    {
+        T r{0};
+        detail::unroll<N>([&](size_t i) {r += a[i] * b[i];});
+        return r;
+    }
+    else return dot(a, b, N);
+}
+
+template <size_t N, Element T>
+T sum(const T* a)
+{
+    if constexpr (N <= UnrollLimit)
+    {
+        T r{0};
+        detail::unroll<N>([&](size_t i) {r += a[i];});
+        return r;
+    }
+    else return sum(a, N);
+}
+
+template <size_t N, Element T>
+T min(const T* a)
+{
+    if constexpr (N <= UnrollLimit)
+    {
+        T r = std::numeric_limits<T>::max();
+        detail::unroll<N>([&](size_t i) {r = std::min(r, a[i]);});
+        return r;
+    }
+    else return min(a, N);
+}
+
+template <size_t N, Element T>
+T max(const T* a)
+{
+    if constexpr (N <= UnrollLimit)
+    {
+        T r = std::numeric_limits<T>::lowest();
+        detail::unroll<N>([&](size_t i) {r = std::max(r, a[i]);});
+        return r;
+    }
+    else return max(a, N);
+}
+
+} // namespace simd
+
+/*
+Why vector extensions and not intrinsics?
+    _mm256_add_pd and friends tie the code to one instruction set and one type;
+    covering four types, SSE/AVX/AVX-512 and ARM would mean a dozen copies of every
+    kernel. A GCC/Clang vector type (`T __attribute__((vector_size(32)))`) supports
+    the usual operators and lowers to the widest instructions the target allows.
+
+Why is the tail scalar?
+    At most Lanes-1 elements are left after the vector loop. AVX-512 could handle
+    them with one masked load/store, but masks are not portable, and for arrays of
+    more than a few dozen elements the tail is a rounding error.
+
+Compile-time sizes:
+    For small N the unrolled form has no loop, no tail and no length checks; the
+    compiler sees N independent operations and packs them into vector instructions
+    itself. fastAdd<T, N> does the same by recursion, one instantiation per element.
+*/
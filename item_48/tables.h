@@ -0,0 +1,250 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// Lookup tables built by the compiler: whole std::arrays computed in constexpr
+// functions, so that at runtime factorial(n) or binomial(n, k) is a single load.
+//
+//     tables::Factorials<uint64_t, 21>[n]          // n!, n = 0 .. 20
+//     tables::Binomials<uint64_t, 68>[n][k]        // C(n, k), n < 68 (0 for k > n)
+//     tables::Powers<uint64_t, 3, 41>[k]           // 3^k
+//     tables::LogFactorials<1000>[n]               // ln(n!) as double
+//
+// Unlike Factorial<N> in main.cpp (one template instantiation per value), a table
+// is one constexpr loop. Every table checks its own arithmetic: if an entry does
+// not fit in T, the build fails with a static_assert instead of wrapping around.
+// For entries beyond uint64_t use tables::uint128 or tables::WideUInt<Words>, an
+// unsigned integer of Words 64-bit words (Factorials<WideUInt<4>, 58> holds 57!).
+
+namespace tables
+{
+
+__extension__ typedef unsigned __int128 uint128;
+
+// Multiword unsigned integer, little-endian words. Only what the tables need:
+// construction from uint64_t, += and *= uint64_t (with overflow detection), ==,
+// and conversion to decimal.
+template <size_t Words>
+struct WideUInt
+{
+    static_assert(Words > 0);
+    std::array<uint64_t, Words> word{};
+
+    constexpr WideUInt() = default;
+    constexpr WideUInt(uint64_t value) {word[0] = value;}
+
+    friend constexpr bool operator==(const WideUInt&, const WideUInt&) = default;
+};
+
+namespace detail
+{
+
+// a *= b and a += b; true if the exact result did not fit (a is then truncated).
+template <typename T>
+constexpr bool mulOverflows(T& a, uint64_t b) {return __builtin_mul_overflow(a, b, &a);}
+
+template <typename T>
+constexpr bool addOverflows(T& a, const T& b) {return __builtin_add_overflow(a, b, &a);}
+
+template <size_t Words>
+constexpr bool mulOverflows(WideUInt<Words>& a, uint64_t b)
+{
+    uint64_t carry = 0;
+    for(uint64_t& w : a.word)
+    {
+        uint128 p = uint128(w) * b + carry;
+        w = uint64_t(p);
+        carry = uint64_t(p >> 64);
+    }
+    return carry != 0;
+}
+
+template <size_t Words>
+constexpr bool addOverflows(WideUInt<Words>& a, const WideUInt<Words>& b)
+{
+    uint64_t carry = 0;
+    for(size_t i = 0; i < Words; ++i)
+    {
+        uint128 s = uint128(a.word[i]) + b.word[i] + carry;
+        a.word[i] = uint64_t(s);
+        carry = uint64_t(s >> 64);
+    }
+    return carry != 0;
+}
+
+template <typename Table>
+struct Built
+{
+    Table table{};
+    bool overflow{false};
+};
+
+template <typename T, size_t N>
+constexpr Built<std::array<T, N>> factorials()
+{
+    Built<std::array<T, N>> r;
+    T f{1};
+    for(size_t n = 0; n < N; ++n)
+    {
+        if(n > 0) r.overflow |= mulOverflows(f, n);
+        r.table[n] = f;
+    }
+    return r;
+}
+
+// Pascal's triangle: additions only, so every entry that fits is exact.
+template <typename T, size_t N>
+constexpr Built<std::array<std::array<T, N>, N>> binomials()
+{
+    Built<std::array<std::array<T, N>, N>> r;
+    for(size_t n = 0; n < N; ++n)
+    {
+        r.table[n][0] = T{1};
+        for(size_t k = 1; k <= n; ++k)
+        {
+            T c = r.table[n-1][k-1];
+            r.overflow |= addOverflows(c, r.table[n-1][k]);
+            r.table[n][k] = c;
+        }
+    }
+    return r;
+}
+
+template <typename T, uint64_t Base, size_t N>
+constexpr Built<std::array<T, N>> powers()
+{
+    Built<std::array<T, N>> r;
+    T p{1};
+    for(size_t k = 0; k < N; ++k)
+    {
+        if(k > 0) r.overflow |= mulOverflows(p, Base);
+        r.table[k] = p;
+    }
+    return r;
+}
+
+// std::log is not constexpr (until C++26). x = m * 2^e with m in [1, 2), and
+// ln(m) = 2 atanh(z) = 2 (z + z^3/3 + z^5/5 + ...) with z = (m-1)/(m+1) <= 1/3,
+// which is converged to double precision after 30 terms.
+constexpr double log(double x)
+{
+    constexpr double Ln2 = 0.693147180559945309417232121458176568;
+    int e = 0;
+    while(x >= 2) {x /= 2; ++e;}
+    while(x < 1) {x *= 2; --e;}
+    double z = (x - 1) / (x + 1), z2 = z * z, term = z, sum = 0;
+    for(int k = 1; k < 60; k += 2)
+    {
+        sum += term / k;
+        term *= z2;
+    }
+    return 2 * sum + e * Ln2;
+}
+
+template <size_t N>
+constexpr std::array<double, N> logFactorials()
+{
+    std::array<double, N> t{};
+    for(size_t n = 1; n < N; ++n) t[n] = t[n-1] + log(double(n));
+    return t;
+}
+
+} // namespace detail
+
+// The largest n such that n! fits in T: 20 for uint64_t, 34 for uint128.
+template <typename T>
+constexpr size_t maxFactorialArgument()
+{
+    T f{1};
+    size_t n = 0;
+    while(!detail::mulOverflows(f, n + 1)) ++n;
+    return n;
+}
+
+// 0! .. (N-1)!
+template <typename T, size_t N>
+inline constexpr std::array<T, N> Factorials = [] {
+    constexpr auto r = detail::factorials<T, N>();
+    static_assert(!r.overflow, "factorial overflows T: use fewer entries or a wider type");
+    return r.table;
+}();
+
+// C(n, k) for 0 <= n, k < N; 0 where k > n.
+template <typename T, size_t N>
+inline constexpr std::array<std::array<T, N>, N> Binomials = [] {
+    constexpr auto r = detail::binomials<T, N>();
+    static_assert(!r.overflow, "binomial coefficient overflows T: use fewer rows or a wider type");
+    return r.table;
+}();
+
+// Base^0 .. Base^(N-1)
+template <typename T, uint64_t Base, size_t N>
+inline constexpr std::array<T, N> Powers = [] {
+    constexpr auto r = detail::powers<T, Base, N>();
+    static_assert(!r.overflow, "power overflows T: use fewer entries or a wider type");
+    return r.table;
+}();
+
+// ln(0!) .. ln((N-1)!); relative difference from std::lgamma(n + 1) below 1e-14.
+template <size_t N>
+inline constexpr std::array<double, N> LogFactorials = detail::logFactorials<N>();
+
+// Decimal representations, for printing the wide types.
+inline std::string toString(uint128 value)
+{
+    std::string s;
+    do {s.insert(s.begin(), char('0' + unsigned(value % 10))); value /= 10;} while(value != 0);
+    return s;
+}
+
+inline std::string toString(uint64_t value) {return std::to_string(value);}
+
+template <size_t Words>
+std::string toString(WideUInt<Words> value)
+{
+    // Divide the whole number by 10^19 (the largest power of 10 in a word) and
+    // collect the remainders: each one is 19 decimal digits of the result.
+    constexpr uint64_t Chunk = 10000000000000000000ull;
+    std::string s;
+    for(;;)
+    {
+        uint64_t remainder = 0;
+        bool zero = true;
+        for(size_t i = Words; i-- > 0;)
+        {
+            uint128 current = (uint128(remainder) << 64) | value.word[i];
+            value.word[i] = uint64_t(current / Chunk);
+            remainder = uint64_t(current % Chunk);
+            zero &= value.word[i] == 0;
+        }
+        std::string digits = std::to_string(remainder);
+        if(!zero) digits.insert(0, 19 - digits.size(), '0');
+        s.insert(0, digits);
+        if(zero) return s;
+    }
+}
+
+} // namespace tables
+
+/*
+Why tables?
+    A function like binomial(n, k) computed at runtime is a loop with a division
+    per step; with n and k varying from call to call it is also a loop with an
+    unpredictable trip count. For the ranges where the result fits in an integer
+    the whole function has only a few thousand possible values, so it is cheaper
+    to compute them all once, at compile time, and index.
+
+Why check overflow?
+    Unsigned arithmetic wraps around silently, also in constant expressions:
+    Factorial<21>::value used to compile to a wrong number. The checked
+    operations are GCC/Clang's __builtin_*_overflow (usable in constexpr) for
+    built-in types and an explicit carry for WideUInt.
+
+Table sizes:
+    Binomials<T, N> has N * N entries; Binomials<uint64_t, 68> is 36 KiB, which
+    is about as large as a table should get before lookups start missing the
+    cache and a computation becomes competitive again.
+*/
@@ -0,0 +1,238 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Expression templates: Vec<T> arithmetic that builds no temporaries.
+//
+//     Vec<double> r = a * b + 2.0 * c - d;
+//
+// `a * b` does not compute anything: it returns a small object that remembers its
+// operands and the operation. `+ 2.0 * c` wraps that in another node, and so on, so
+// the right-hand side is a tree of nodes whose type spells out the whole formula.
+// Only the assignment to `r` runs a loop, a single one, evaluating the formula
+// element by element: r[i] = a[i] * b[i] + 2.0 * c[i] - d[i].
+// Reductions (sum, dot) walk the tree the same way and allocate nothing.
+//
+// As with any lazy value, an expression refers to its Vec operands: evaluate it
+// (assign it to a Vec, or reduce it) before they go away. Do not keep one in `auto`.
+//
+// Everything lives in namespace vecexpr; the operators and functions (sum, sqrt,
+// min, ...) are found by argument-dependent lookup, so only Vec needs qualifying.
+
+namespace vecexpr
+{
+
+// CRTP base of every expression (the leaves, Vec<T>, included): gives the
+// operators a single type to match and forwards to the concrete node.
+template <typename E>
+class VecExpr
+{
+public:
+    size_t size() const {return self().size();}
+    auto operator[](size_t i) const {return self()[i];}
+    const E& self() const {return static_cast<const E&>(*this);}
+protected:
+    VecExpr() = default;
+};
+
+template <typename T>
+class Vec : public VecExpr<Vec<T>>
+{
+public:
+    using value_type = T;
+
+    Vec() = default;
+    explicit Vec(size_t n, T value = T{}) : data(n, value) {}
+    Vec(std::initializer_list<T> values) : data(values) {}
+
+    // Evaluating an expression: one loop, no temporaries.
+    template <typename E>
+    Vec(const VecExpr<E>& e) : data(e.size())
+    {
+        assign(e);
+    }
+
+    template <typename E>
+    Vec& operator=(const VecExpr<E>& e)
+    {
+        data.resize(e.size());
+        assign(e); // element i is read before it is written, so `a = a + b` is fine
+        return *this;
+    }
+
+    template <typename E> Vec& operator+=(const VecExpr<E>& e) {return *this = *this + e;}
+    template <typename E> Vec& operator-=(const VecExpr<E>& e) {return *this = *this - e;}
+    template <typename E> Vec& operator*=(const VecExpr<E>& e) {return *this = *this * e;}
+    template <typename E> Vec& operator/=(const VecExpr<E>& e) {return *this = *this / e;}
+
+    size_t size() const {return data.size();}
+    T operator[](size_t i) const {return data[i];}
+    T& operator[](size_t i) {return data[i];}
+    const T* begin() const {return data.data();}
+    const T* end() const {return data.data() + data.size();}
+
+private:
+    template <typename E>
+    void assign(const VecExpr<E>& e)
+    {
+        const E& expr = e.self();
+        T* out = data.data();
+        size_t n = data.size();
+        for(size_t i = 0; i < n; ++i) out[i] = expr[i];
+    }
+
+    std::vector<T> data;
+};
+
+namespace detail
+{
+
+template <typename T> struct IsVec : std::false_type {};
+template <typename T> struct IsVec<Vec<T>> : std::true_type {};
+
+// Vec operands are held by reference (copying them would be the very temporary we
+// avoid); inner nodes are small and held by value, since they are usually temporaries.
+template <typename E>
+using Stored = std::conditional_t<IsVec<E>::value, const E&, E>;
+
+// A scalar operand: the same value at every index. It keeps its own type, so
+// the operation promotes as it would for single values: Vec<int> * 1.5 is
+// computed in double, not with 1.5 truncated to 1.
+template <typename T>
+class Scalar : public VecExpr<Scalar<T>>
+{
+public:
+    explicit Scalar(T value_, size_t n_) : value{value_}, n{n_} {}
+    size_t size() const {return n;}
+    T operator[](size_t) const {return value;}
+private:
+    T value;
+    size_t n;
+};
+
+template <typename L, typename R, typename Op>
+class Binary : public VecExpr<Binary<L, R, Op>>
+{
+public:
+    Binary(const L& l_, const R& r_) : l{l_}, r{r_}
+    {
+        if(l.size() != r.size()) throw std::invalid_argument("Vec: operands of different sizes");
+    }
+    size_t size() const {return l.size();}
+    auto operator[](size_t i) const {return Op{}(l[i], r[i]);}
+private:
+    Stored<L> l;
+    Stored<R> r;
+};
+
+template <typename E, typename Op>
+class Unary : public VecExpr<Unary<E, Op>>
+{
+public:
+    explicit Unary(const E& e_) : e{e_} {}
+    size_t size() const {return e.size();}
+    auto operator[](size_t i) const {return Op{}(e[i]);}
+private:
+    Stored<E> e;
+};
+
+struct Add {template <typename A, typename B> auto operator()(A a, B b) const {return a + b;}};
+struct Sub {template <typename A, typename B> auto operator()(A a, B b) const {return a - b;}};
+struct Mul {template <typename A, typename B> auto operator()(A a, B b) const {return a * b;}};
+struct Div {template <typename A, typename B> auto operator()(A a, B b) const {return a / b;}};
+struct Min {template <typename A, typename B> auto operator()(A a, B b) const {return std::min(a, b);}};
+struct Max {template <typename A, typename B> auto operator()(A a, B b) const {return std::max(a, b);}};
+struct Neg {template <typename A> auto operator()(A a) const {return -a;}};
+struct Abs {template <typename A> auto operator()(A a) const {return std::abs(a);}};
+struct Sqrt {template <typename A> auto operator()(A a) const {return std::sqrt(a);}};
+struct Exp {template <typename A> auto operator()(A a) const {return std::exp(a);}};
+
+template <typename E>
+using ValueOf = decltype(std::declval<const E&>()[0]);
+
+} // namespace detail
+
+// Vec op Vec, expression op expression
+#define VEC_BINARY_OPERATOR(op, Op)                                                                     \
+    template <typename L, typename R>                                                                   \
+    auto operator op(const VecExpr<L>& l, const VecExpr<R>& r)                                          \
+    {                                                                                                   \
+        return detail::Binary<L, R, detail::Op>(l.self(), r.self());                                    \
+    }                                                                                                   \
+    template <typename L, typename S> requires std::is_arithmetic_v<S>                                  \
+    auto operator op(const VecExpr<L>& l, S s)                                                          \
+    {                                                                                                   \
+        using Sc = detail::Scalar<S>;                                                                   \
+        return detail::Binary<L, Sc, detail::Op>(l.self(), Sc(s, l.size()));                            \
+    }                                                                                                   \
+    template <typename S, typename R> requires std::is_arithmetic_v<S>                                  \
+    auto operator op(S s, const VecExpr<R>& r)                                                          \
+    {                                                                                                   \
+        using Sc = detail::Scalar<S>;                                                                   \
+        return detail::Binary<Sc, R, detail::Op>(Sc(s, r.size()), r.self());                            \
+    }
+
+VEC_BINARY_OPERATOR(+, Add)
+VEC_BINARY_OPERATOR(-, Sub)
+VEC_BINARY_OPERATOR(*, Mul)
+VEC_BINARY_OPERATOR(/, Div)
+#undef VEC_BINARY_OPERATOR
+
+template <typename E> auto operator-(const VecExpr<E>& e) {return detail::Unary<E, detail::Neg>(e.self());}
+
+// Elementwise functions
+template <typename E> auto abs(const VecExpr<E>& e) {return detail::Unary<E, detail::Abs>(e.self());}
+template <typename E> auto sqrt(const VecExpr<E>& e) {return detail::Unary<E, detail::Sqrt>(e.self());}
+template <typename E> auto exp(const VecExpr<E>& e) {return detail::Unary<E, detail::Exp>(e.self());}
+template <typename L, typename R>
+auto min(const VecExpr<L>& l, const VecExpr<R>& r) {return detail::Binary<L, R, detail::Min>(l.self(), r.self());}
+template <typename L, typename R>
+auto max(const VecExpr<L>& l, const VecExpr<R>& r) {return detail::Binary<L, R, detail::Max>(l.self(), r.self());}
+
+// Reductions: evaluate the expression element by element into an accumulator.
+template <typename E>
+auto sum(const VecExpr<E>& e)
+{
+    const E& expr = e.self();
+    detail::ValueOf<E> total{};
+    for(size_t i = 0, n = expr.size(); i < n; ++i) total += expr[i];
+    return total;
+}
+
+template <typename L, typename R>
+auto dot(const VecExpr<L>& l, const VecExpr<R>& r) {return sum(l * r);}
+
+} // namespace vecexpr
+
+/*
+What does the compiler see?
+    For r = a * b + c the type of the right-hand side is
+        Binary<Binary<Vec, Vec, Mul>, Vec, Add>
+    and its operator[] inlines to a[i] * b[i] + c[i]. The assignment loop is
+    exactly the loop one would write by hand, and it vectorises like one.
+
+Why does it matter?
+    Evaluated eagerly, a * b + c allocates a temporary for a * b, writes it, and
+    reads it back for the addition: per element 5 memory accesses (read a, read
+    b, write t, read t, read c) plus the final write, instead of 4. Every extra
+    operation adds another full pass over memory. For arrays larger than the
+    caches, time is proportional to memory traffic, so removing the temporaries
+    is the optimisation.
+
+Scalars and element types:
+    An expression's element type is whatever the operations produce:
+    Vec<int>{1, 2, 3} * 1.5 has double elements {1.5, 3, 4.5}. It is
+    converted only when it is assigned, so Vec<int> r = v * 1.5 holds {1, 3, 4},
+    the same as r[i] = v[i] * 1.5 in a loop. The flip side: Vec<float> * 2.0
+    computes in double; write 2.0f to stay in float.
+
+Why the macro?
+    Each operator needs the same three overloads (expr op expr, expr op scalar,
+    scalar op expr); the macro writes them once instead of twelve times.
+*/
@@ -0,0 +1,142 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "vec.h"
+
+// The same formulas evaluated three ways:
+//   eager:     operators on std::vector<double> that each return a new vector
+//   lazy:      vecexpr::Vec<double>, expression templates
+//   hand loop: the single loop one would write by hand
+// Two workloads: r = a * b + c * d - e, and s = sum(a * b + c). Each runs on an
+// array that fits in L1 and on one far larger than the caches, where memory
+// traffic decides the time. Usage: ./vec_benchmark [large size, default 4000000]
+
+using Clock = std::chrono::steady_clock;
+
+// Counts heap allocations, to show that the lazy version makes none.
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    if(void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete(void* p, size_t) noexcept {std::free(p);}
+
+namespace Eager
+{
+
+using V = std::vector<double>;
+
+template <typename Op>
+V apply(const V& a, const V& b, Op op)
+{
+    V r(a.size());
+    for(size_t i = 0; i < a.size(); ++i) r[i] = op(a[i], b[i]);
+    return r;
+}
+
+V operator+(const V& a, const V& b) {return apply(a, b, [](double x, double y) {return x + y;});}
+V operator-(const V& a, const V& b) {return apply(a, b, [](double x, double y) {return x - y;});}
+V operator*(const V& a, const V& b) {return apply(a, b, [](double x, double y) {return x * y;});}
+
+double sum(const V& a)
+{
+    double s = 0;
+    for(double x : a) s += x;
+    return s;
+}
+
+} // namespace Eager
+
+struct Result
+{
+    double ns;
+    double allocationsPerRun;
+};
+
+template <typename F>
+Result measure(size_t reps, size_t elements, F&& f)
+{
+    size_t before = allocations;
+    auto t0 = Clock::now();
+    for(size_t r = 0; r < reps; ++r)
+    {
+        f();
+        asm volatile("" ::: "memory");
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / (reps * elements);
+    return {ns, double(allocations - before) / reps};
+}
+
+void print(const char* name, Result r, double bytesPerElement)
+{
+    std::printf("  %-10s %7.2f ns/elem  %4.1f allocs/run  %3.0f bytes/elem moved  %6.2f GB/s\n",
+                name, r.ns, r.allocationsPerRun, bytesPerElement, bytesPerElement / r.ns);
+}
+
+void run(size_t n)
+{
+    size_t reps = n < 100000 ? 200000000 / n : 10;
+    std::printf("n = %zu (%.1f KiB per array)\n", n, n * sizeof(double) / 1024.0);
+
+    std::vector<double> ea(n), eb(n), ec(n), ed(n), ee(n), er(n);
+    vecexpr::Vec<double> a(n), b(n), c(n), d(n), e(n), r(n);
+    for(size_t i = 0; i < n; ++i)
+    {
+        ea[i] = a[i] = 1.0 + i % 7;
+        eb[i] = b[i] = 0.5 * (i % 5);
+        ec[i] = c[i] = 2.0 - i % 3;
+        ed[i] = d[i] = 0.25 * (i % 11);
+        ee[i] = e[i] = 1.0 / (1 + i % 13);
+    }
+
+    // Eager: 4 passes, each reading 2 arrays and writing 1 (12 accesses per element);
+    // fused: read 5, write 1.
+    std::printf(" r = a * b + c * d - e\n");
+    print("eager", measure(reps, n, [&] {using namespace Eager; er = ea * eb + ec * ed - ee;}), 12 * 8);
+    print("lazy", measure(reps, n, [&] {r = a * b + c * d - e;}), 6 * 8);
+    print("hand loop", measure(reps, n, [&] {
+        for(size_t i = 0; i < n; ++i) er[i] = ea[i] * eb[i] + ec[i] * ed[i] - ee[i];
+    }), 6 * 8);
+    bool same = true;
+    for(size_t i = 0; i < n; ++i) same &= er[i] == r[i];
+    std::printf("  results equal: %s\n", same ? "yes" : "NO");
+
+    // Eager: a * b (3 accesses), + c (3), sum (1); fused: read 3, write nothing.
+    std::printf(" s = sum(a * b + c)\n");
+    double s1 = 0, s2 = 0, s3 = 0;
+    print("eager", measure(reps, n, [&] {using namespace Eager; s1 = sum(ea * eb + ec);}), 7 * 8);
+    print("lazy", measure(reps, n, [&] {s2 = sum(a * b + c);}), 3 * 8);
+    print("hand loop", measure(reps, n, [&] {
+        double s = 0;
+        for(size_t i = 0; i < n; ++i) s += ea[i] * eb[i] + ec[i];
+        s3 = s;
+    }), 3 * 8);
+    std::printf("  sums: %.17g %.17g %.17g\n", s1, s2, s3);
+}
+
+int main(int argc, char** argv)
+{
+    size_t large = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+    run(1024);
+    run(large);
+}
+
+/*
+Reading the numbers:
+    For the small arrays everything is in L1 and the eager version pays mostly
+    for its allocations and extra loops. For the large ones the loops are bound
+    by memory bandwidth, so time follows "bytes/elem moved": the lazy version
+    moves half (or less) of what the eager one does and runs at the speed of
+    the hand-written loop. The eager version loses more than the traffic ratio
+    suggests: each large temporary is a fresh allocation, and the first write to
+    every one of its pages is a page fault.
+    The sums are summed in the same order by all three, so they match exactly.
+    The lazy and hand-written sums are a single dependency chain of additions;
+    the simd::sum kernel of simdkernels.h shows what several accumulators add.
+*/
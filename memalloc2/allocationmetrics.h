@@ -0,0 +1,178 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+// Thread-safe replacement for the single-counter AllocationMetrics in main.cpp.
+// Every thread writes into its own cache-line aligned shard (lock-free, relaxed
+// atomics that are practically never contended), and readers merge all shards.
+
+struct AllocationSnapshot
+{
+    uint64_t TotalAllocated{0};
+    uint64_t TotalFreed{0};
+    uint64_t AllocationCount{0};
+    uint64_t FreeCount{0};
+    uint64_t PeakUsage{0};
+    std::array<uint64_t, 64> SizeClassAllocs{}; // bucket i holds sizes in [2^(i-1), 2^i)
+    std::array<uint64_t, 64> SizeClassFrees{};
+
+    uint64_t CurrentUsage() const {return TotalAllocated - TotalFreed;}
+    uint64_t LiveAllocations() const {return AllocationCount - FreeCount;}
+};
+
+// One per thread (modulo NumShards), padded to its own cache line.
+struct alignas(64) AllocationShard
+{
+    std::atomic<uint64_t> allocated{0};
+    std::atomic<uint64_t> freed{0};
+    std::atomic<uint64_t> allocCount{0};
+    std::atomic<uint64_t> freeCount{0};
+    std::array<std::atomic<uint64_t>, 64> allocHist{};
+    std::array<std::atomic<uint64_t>, 64> freeHist{};
+};
+
+class AllocationMetrics
+{
+public:
+    static constexpr size_t NumShards = 64;
+    static constexpr size_t NumSizeClasses = 64;
+    static constexpr int64_t PeakFlushBytes = 64 * 1024; // granularity of the peak tracking
+
+    // Off by default: the peak is tracked from batched per-thread deltas and may
+    // be low by up to PeakFlushBytes per thread. On, every allocation and free
+    // updates one shared counter, and the peak is exact but no longer cheap.
+    static void trackExactPeak(bool on) {exactPeak.store(on, std::memory_order_relaxed);}
+
+    static void allocated(size_t size)
+    {
+        Shard& s = shard();
+        s.allocated.fetch_add(size, std::memory_order_relaxed);
+        s.allocCount.fetch_add(1, std::memory_order_relaxed);
+        s.allocHist[sizeClass(size)].fetch_add(1, std::memory_order_relaxed);
+        notePeak(static_cast<int64_t>(size));
+    }
+
+    static void freed(size_t size)
+    {
+        Shard& s = shard();
+        s.freed.fetch_add(size, std::memory_order_relaxed);
+        s.freeCount.fetch_add(1, std::memory_order_relaxed);
+        s.freeHist[sizeClass(size)].fetch_add(1, std::memory_order_relaxed);
+        notePeak(-static_cast<int64_t>(size));
+    }
+
+    static AllocationSnapshot snapshot()
+    {
+        AllocationSnapshot snap;
+        for(const Shard& s : shards)
+        {
+            snap.TotalAllocated += s.allocated.load(std::memory_order_relaxed);
+            snap.TotalFreed += s.freed.load(std::memory_order_relaxed);
+            snap.AllocationCount += s.allocCount.load(std::memory_order_relaxed);
+            snap.FreeCount += s.freeCount.load(std::memory_order_relaxed);
+            for(size_t i = 0; i < NumSizeClasses; ++i)
+            {
+                snap.SizeClassAllocs[i] += s.allocHist[i].load(std::memory_order_relaxed);
+                snap.SizeClassFrees[i] += s.freeHist[i].load(std::memory_order_relaxed);
+            }
+        }
+        // Frees may be merged before the matching allocations of another shard.
+        if(snap.TotalFreed > snap.TotalAllocated) snap.TotalFreed = snap.TotalAllocated;
+        // The shards are read one at a time, so under concurrent use the sum can be
+        // ahead of the shared counter; keep the pair consistent.
+        snap.PeakUsage = std::max(peak.load(std::memory_order_relaxed), snap.CurrentUsage());
+        return snap;
+    }
+
+    static uint64_t CurrentUsage() {return snapshot().CurrentUsage();}
+    static uint64_t PeakUsage() {return snapshot().PeakUsage;}
+
+    // 0 -> 0, 1 -> 1, [2,4) -> 2, ...; sizes of 2^63 and up share the last bucket.
+    static constexpr size_t sizeClass(size_t size) {return std::min<size_t>(std::bit_width(size), NumSizeClasses - 1);}
+
+    static void print(std::ostream& os = std::cout)
+    {
+        AllocationSnapshot snap = snapshot();
+        os << "Current usage: " << snap.CurrentUsage() << " bytes, peak: " << snap.PeakUsage << " bytes\n";
+        os << "Allocations: " << snap.AllocationCount << ", frees: " << snap.FreeCount
+           << ", live: " << snap.LiveAllocations() << "\n";
+        for(size_t i = 0; i < NumSizeClasses; ++i)
+        {
+            if(snap.SizeClassAllocs[i] == 0) continue;
+            size_t lo = i == 0 ? 0 : size_t{1} << (i - 1);
+            os << "  [" << lo << ", " << (i == 0 ? 1 : lo * 2) << "): "
+               << snap.SizeClassAllocs[i] << " allocs, " << snap.SizeClassFrees[i] << " frees\n";
+        }
+    }
+
+private:
+    using Shard = AllocationShard;
+
+    // Thread-local state must be trivially destructible: it is touched from inside
+    // operator new, possibly while the thread is being torn down.
+    static Shard& shard()
+    {
+        thread_local size_t index = NumShards;
+        if(index == NumShards)
+        {
+            index = nextShard.fetch_add(1, std::memory_order_relaxed) % NumShards;
+        }
+        return shards[index];
+    }
+
+    // Each thread batches its net usage change and only publishes it to the shared
+    // counter when it exceeds PeakFlushBytes (as InstanceCounter does with Batch),
+    // so the peak costs one thread-local add on the fast path. A high that lasts
+    // less than a batch can be missed: the peak is low by at most
+    // threads * PeakFlushBytes, unless trackExactPeak is on.
+    static void notePeak(int64_t delta)
+    {
+        thread_local int64_t pending = 0;
+        pending += delta;
+        if(pending < PeakFlushBytes && pending > -PeakFlushBytes && !exactPeak.load(std::memory_order_relaxed)) return;
+        int64_t now = usage.fetch_add(pending, std::memory_order_relaxed) + pending;
+        pending = 0;
+        uint64_t seen = peak.load(std::memory_order_relaxed);
+        while(now > 0 && static_cast<uint64_t>(now) > seen &&
+              !peak.compare_exchange_weak(seen, static_cast<uint64_t>(now), std::memory_order_relaxed)) {}
+    }
+
+    inline static std::array<Shard, NumShards> shards{};
+    inline static std::atomic<size_t> nextShard{0};
+    inline static std::atomic<int64_t> usage{0};
+    inline static std::atomic<uint64_t> peak{0};
+    inline static std::atomic<bool> exactPeak{false};
+};
+
+/*
+Why shards instead of one std::atomic per counter?
+    A single atomic counter is correct, but every allocation on every core would
+    write the same cache line, which then ping-pongs between cores. With one shard
+    per thread each core keeps its own line in its cache and the relaxed fetch_add
+    is about as cheap as a plain add. The cost moves to the (rare) reader, which
+    has to walk all the shards and add them up.
+
+Why alignas(64)?
+    Without it two shards could share a cache line and we would get false sharing:
+    logically independent counters that still invalidate each other's caches.
+
+Why are the thread_locals plain integers?
+    operator new can run during thread start-up and shutdown. A thread_local with a
+    non-trivial destructor would need registration on first use, which itself may
+    allocate. Plain integers are zero-cost to set up and need no destruction.
+
+How exact is the peak?
+    A peak is a maximum over time of the sum over all threads, so it cannot be
+    folded from per-shard highs: their sum overestimates, their maximum
+    underestimates. By default each thread publishes its net change every
+    PeakFlushBytes, and the peak is taken over the published totals; it may miss
+    a high by up to PeakFlushBytes per thread, but never drops below the usage
+    of a snapshot. trackExactPeak(true) publishes every change instead, at the
+    price of the one shared cache line the shards are there to avoid: use it
+    for tests and small tools, not for a production server.
+*/
@@ -0,0 +1,183 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include "allocationmetrics.h"
+
+// Monotonic (bump-pointer) arena: allocation is "round up and advance a pointer",
+// deallocation does nothing (apart from undoing the latest allocation), and
+// everything is released at once when the arena is destroyed. Chunks come
+// straight from malloc and grow geometrically.
+//
+// It is a std::pmr::memory_resource, so it can back pmr containers directly:
+//     MonotonicArena arena;
+//     std::pmr::vector<int> v{&arena};
+
+class MonotonicArena : public std::pmr::memory_resource
+{
+public:
+    explicit MonotonicArena(size_t initialChunk = 64 * 1024) : nextChunkSize{initialChunk} {}
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+    ~MonotonicArena() override {release();}
+
+    void* allocateBytes(size_t bytes, size_t alignment = alignof(std::max_align_t))
+    {
+        uintptr_t p = (cursor + alignment - 1) & ~(uintptr_t{alignment} - 1);
+        // Written so that nothing can wrap: a huge request goes to grow(), which throws.
+        if(p < cursor || p >= end || bytes > end - p)
+        {
+            if(bytes > SIZE_MAX - alignment) throw std::bad_alloc();
+            grow(bytes + alignment);
+            p = (cursor + alignment - 1) & ~(uintptr_t{alignment} - 1);
+        }
+        cursor = p + bytes;
+        last = p;
+        used += bytes;
+        return reinterpret_cast<void*>(p);
+    }
+
+    // Frees are no-ops, except for the most recent allocation, whose space is
+    // reused. That is what makes "allocate, use, free" inside a loop stay in
+    // the same few cache lines instead of marching through the whole chunk.
+    void deallocateBytes(void* memory)
+    {
+        if(reinterpret_cast<uintptr_t>(memory) != last) return;
+        used -= cursor - last;
+        cursor = last;
+        last = 0;
+    }
+
+    bool owns(const void* memory) const
+    {
+        uintptr_t p = reinterpret_cast<uintptr_t>(memory);
+        for(const Chunk* c = chunks; c; c = c->next)
+        {
+            if(p >= reinterpret_cast<uintptr_t>(c) && p < reinterpret_cast<uintptr_t>(c) + c->size) return true;
+        }
+        return false;
+    }
+
+    // Frees every chunk. Anything allocated from the arena is gone afterwards.
+    void release()
+    {
+        while(chunks)
+        {
+            Chunk* next = chunks->next;
+            AllocationMetrics::freed(chunks->size);
+            std::free(chunks);
+            chunks = next;
+        }
+        cursor = end = last = 0;
+        used = 0;
+    }
+
+    size_t bytesUsed() const {return used;}
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {return allocateBytes(bytes, alignment);}
+    void do_deallocate(void* memory, size_t, size_t) override {deallocateBytes(memory);}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {return this == &other;}
+
+private:
+    struct Chunk
+    {
+        Chunk* next;
+        size_t size;
+    };
+
+    void grow(size_t atLeast)
+    {
+        // Doubling must neither wrap nor start from 0; a request no chunk can
+        // hold is bad_alloc, as it is for malloc.
+        if(atLeast > SIZE_MAX - sizeof(Chunk)) throw std::bad_alloc();
+        size_t size = std::max(nextChunkSize, sizeof(Chunk));
+        while(size < atLeast + sizeof(Chunk))
+        {
+            if(size > SIZE_MAX / 2) {size = atLeast + sizeof(Chunk); break;}
+            size *= 2;
+        }
+        Chunk* c = static_cast<Chunk*>(std::malloc(size)); // not operator new: the hook may route here
+        if(!c) throw std::bad_alloc();
+        nextChunkSize = size > SIZE_MAX / 2 ? size : size * 2; // only once it worked: a failed request leaves no trace
+        AllocationMetrics::allocated(size); // the arena reports whole chunks, not single objects
+        c->next = chunks;
+        c->size = size;
+        chunks = c;
+        cursor = reinterpret_cast<uintptr_t>(c) + sizeof(Chunk);
+        end = reinterpret_cast<uintptr_t>(c) + size;
+    }
+
+    Chunk* chunks{nullptr};
+    uintptr_t cursor{0};
+    uintptr_t end{0};
+    uintptr_t last{0};
+    size_t used{0};
+    size_t nextChunkSize;
+};
+
+// While an ArenaScope is alive, every operator new on this thread is served by its
+// arena and operator delete of arena memory goes back to the arena (see newhooks.h).
+// Scopes nest; the innermost one wins. Without an active scope the global hook
+// behaves exactly as before.
+//
+// Objects allocated inside a scope must not outlive it, and must be destroyed on the
+// thread that created them: the memory disappears when the scope ends.
+class ArenaScope
+{
+public:
+    explicit ArenaScope(size_t initialChunk = 64 * 1024) : arena{initialChunk}, previous{top()}
+    {
+        top() = this;
+    }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+    ~ArenaScope() {top() = previous;} // arena's destructor then frees all chunks
+
+    MonotonicArena& resource() {return arena;}
+
+    static ArenaScope* current() {return top();}
+
+    // Returns true if some active scope of this thread handed out `memory`
+    // (and took it back); false means the memory belongs to the normal allocator.
+    static bool deallocate(void* memory)
+    {
+        for(ArenaScope* s = top(); s; s = s->previous)
+        {
+            if(s->arena.owns(memory))
+            {
+                s->arena.deallocateBytes(memory);
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static ArenaScope*& top()
+    {
+        thread_local ArenaScope* scope = nullptr;
+        return scope;
+    }
+
+    MonotonicArena arena;
+    ArenaScope* previous;
+};
+
+/*
+Why is an arena fast?
+    A general-purpose allocator must be able to free any block at any time, so it
+    keeps per-block bookkeeping and searches free lists. An arena gives up
+    individual frees: allocation is a pointer bump and the whole region is dropped
+    in one go. For loops that create many short-lived objects (item_26) this turns
+    n malloc/free pairs into a handful of chunk allocations.
+
+Why a thread-local stack of scopes?
+    The scope must affect allocations made deep inside library code (std::string,
+    std::vector) that knows nothing about arenas. The global operator new can only
+    find the arena through some global state, and making it thread-local keeps
+    other threads on the normal allocator.
+*/
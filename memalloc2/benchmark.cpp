@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "newhooks.h"
+
+// Multi-threaded small-object churn: every thread keeps a window of live objects
+// and keeps replacing random ones with new allocations of random small sizes.
+// Run without arguments to compare glibc malloc and SlabAllocator, each one in
+// its own child process so the RSS numbers do not contaminate each other.
+//
+//     ./benchmark [threads] [operations per thread]
+//     ./benchmark malloc|slab|tracked|sampled [threads] [operations per thread]
+//
+// "tracked" is malloc with LeakTracker enabled, to measure the tracking overhead;
+// "sampled" is the same with one block in 64 tracked.
+
+using Clock = std::chrono::steady_clock;
+
+struct Object
+{
+    unsigned char* data;
+    size_t size;
+};
+
+void churn(uint64_t seed, size_t ops)
+{
+    constexpr size_t Window = 4096;
+    std::vector<Object> live(Window, Object{nullptr, 0});
+    uint64_t x = seed * 0x9E3779B97F4A7C15ull + 1;
+    for(size_t i = 0; i < ops; ++i)
+    {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift64
+        Object& o = live[x % Window];
+        if(o.data) ::operator delete(o.data, o.size);
+        o.size = 8 + (x >> 32) % 249;                 // 8..256 bytes
+        o.data = static_cast<unsigned char*>(::operator new(o.size));
+        o.data[0] = static_cast<unsigned char>(i);    // touch the memory
+    }
+    for(Object& o : live)
+    {
+        if(o.data) ::operator delete(o.data, o.size);
+    }
+}
+
+long residentKiB()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while(std::getline(status, line))
+    {
+        if(line.rfind("VmHWM:", 0) == 0) return std::stol(line.substr(6)); // peak RSS
+    }
+    return -1;
+}
+
+void run(const std::string& mode, unsigned threads, size_t ops)
+{
+    if(mode == "slab") SlabAllocator::enable();
+    if(mode == "tracked") LeakTracker::enable(); // malloc plus the live-allocation table
+    if(mode == "sampled") LeakTracker::enable(size_t{1} << 20, 64);
+    auto t0 = Clock::now();
+    std::vector<std::thread> pool;
+    for(unsigned t = 0; t < threads; ++t) pool.emplace_back(churn, t + 1, ops);
+    for(auto& th : pool) th.join();
+    double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+    double mops = threads * ops / secs / 1e6;
+    std::printf("%-8s threads=%-3u %8.2f Mops/s  %7.1f ns/op  peak RSS %7ld KiB\n",
+                mode.c_str(), threads, mops, 1e3 / mops * threads, residentKiB());
+}
+
+int main(int argc, char** argv)
+{
+    int arg = 1;
+    std::string mode;
+    if(argc > 1 && (std::strcmp(argv[1], "malloc") == 0 || std::strcmp(argv[1], "slab") == 0 ||
+                    std::strcmp(argv[1], "tracked") == 0 || std::strcmp(argv[1], "sampled") == 0)) mode = argv[arg++];
+    unsigned threads = argc > arg ? std::stoul(argv[arg]) : std::max(1u, std::thread::hardware_concurrency());
+    size_t ops = argc > arg + 1 ? std::stoul(argv[arg + 1]) : 2'000'000;
+
+    if(!mode.empty())
+    {
+        run(mode, threads, ops);
+        return 0;
+    }
+    std::cout.flush();
+    for(const char* m : {"malloc", "slab", "tracked", "sampled"})
+    {
+        pid_t pid = fork();
+        if(pid == 0)
+        {
+            run(m, threads, ops);
+            std::fflush(stdout);
+            _exit(0);
+        }
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+/*
+What to expect:
+    With one thread glibc's malloc is already fast (its tcache is a per-thread
+    cache too), so the slab allocator wins mostly by skipping malloc's chunk
+    headers and bin bookkeeping. The gap widens with more threads, when malloc
+    has to go back to its locked arenas more often while the slab thread caches
+    stay private.
+
+    Peak RSS tends to be higher for the slab allocator: carving a span touches a
+    whole 256 KiB for one size class, and memory is never returned to the OS.
+    That is the usual speed/footprint trade-off of thread-caching allocators.
+*/
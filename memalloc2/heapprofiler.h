@@ -0,0 +1,228 @@
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+// Sampling heap profiler in the style of tcmalloc: instead of recording every
+// allocation, each thread records one backtrace roughly every SampleRate bytes.
+// The distance to the next sample is drawn from an exponential distribution, so
+// sample points form a Poisson process over the allocated bytes and allocations
+// of any size (or any allocation pattern) are sampled without bias.
+//
+// Samples are aggregated by call stack and can be dumped as folded stacks:
+//     main;buildIndex;std::vector<int>::reserve 1048576
+// which flamegraph.pl / speedscope / inferno read directly.
+
+// Function name of a return address, or module+offset if the symbol is not exported.
+inline std::string symbolize(void* addr)
+{
+    Dl_info info{};
+    if(dladdr(addr, &info) && info.dli_sname)
+    {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::string name = status == 0 ? demangled : info.dli_sname;
+        std::free(demangled);
+        return name;
+    }
+    // Unexported symbol: module+offset, resolvable with addr2line. dladdr may leave
+    // dli_fname null, and a module name need not contain a '/'.
+    const char* module = info.dli_fname ? info.dli_fname : "??";
+    if(const char* slash = std::strrchr(module, '/')) module = slash + 1;
+    std::ostringstream os;
+    os << module << "+0x" << std::hex
+       << (reinterpret_cast<uintptr_t>(addr) - reinterpret_cast<uintptr_t>(info.dli_fbase));
+    return os.str();
+}
+
+// Aggregated samples for one call stack.
+template <size_t MaxDepth>
+struct HeapSampleStack
+{
+    uint64_t hash{0};
+    size_t depth{0};
+    void* frames[MaxDepth]{};
+    double bytes{0};
+    double count{0};
+};
+
+class HeapProfiler
+{
+public:
+    static constexpr size_t MaxDepth = 32;
+    static constexpr size_t MaxStacks = 4096;
+
+    static void start(size_t sampleRate = 512 * 1024)
+    {
+        rate.store(sampleRate, std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_relaxed); // threads redraw their countdown
+        active.store(true, std::memory_order_release);
+    }
+
+    static void stop() {active.store(false, std::memory_order_release);}
+    static bool enabled() {return active.load(std::memory_order_relaxed);}
+
+    // Called from operator new. The fast path is one relaxed load and one subtraction.
+    static void sampleAllocation(size_t size)
+    {
+        if(!active.load(std::memory_order_relaxed)) return;
+        ThreadState& ts = threadState();
+        ts.bytesUntilSample -= static_cast<int64_t>(size);
+        if(ts.bytesUntilSample > 0) return;
+        recordSample(ts, size);
+    }
+
+    // Estimated bytes allocated per stack since start(), as folded stacks.
+    static void dumpFolded(std::ostream& os)
+    {
+        ThreadState& ts = threadState();
+        ts.busy = true; // allocations made while dumping must not be sampled (or deadlock on the lock)
+        lock();
+        for(size_t i = 0; i < MaxStacks; ++i)
+        {
+            const Stack& st = stacks[i];
+            if(st.depth == 0) continue;
+            std::string line;
+            for(size_t f = st.depth; f-- > 0;) // outermost frame first
+            {
+                line += symbolize(st.frames[f]);
+                if(f != 0) line += ';';
+            }
+            os << line << ' ' << static_cast<uint64_t>(st.bytes) << '\n';
+        }
+        unlock();
+        ts.busy = false;
+    }
+
+    static void reset()
+    {
+        lock();
+        for(Stack& st : stacks) st = Stack{};
+        unlock();
+    }
+
+    static uint64_t sampleCount() {return samples.load(std::memory_order_relaxed);}
+
+private:
+    struct ThreadState
+    {
+        int64_t bytesUntilSample;
+        uint64_t rng;
+        uint64_t generation;
+        bool busy;
+    };
+
+    using Stack = HeapSampleStack<MaxDepth>;
+
+    // Trivially destructible, so it is safe to touch from inside operator new.
+    static ThreadState& threadState()
+    {
+        thread_local ThreadState ts{0, 0, 0, false};
+        return ts;
+    }
+
+    static int64_t nextInterval(ThreadState& ts)
+    {
+        if(ts.rng == 0) ts.rng = reinterpret_cast<uintptr_t>(&ts) * 0x9E3779B97F4A7C15ull | 1;
+        ts.rng ^= ts.rng << 13; // xorshift64
+        ts.rng ^= ts.rng >> 7;
+        ts.rng ^= ts.rng << 17;
+        double u = ((ts.rng >> 11) + 1) * (1.0 / 9007199254740993.0); // (0, 1]
+        return static_cast<int64_t>(-std::log(u) * static_cast<double>(rate.load(std::memory_order_relaxed))) + 1;
+    }
+
+    [[gnu::noinline]] static void recordSample(ThreadState& ts, size_t size)
+    {
+        uint64_t gen = generation.load(std::memory_order_relaxed);
+        if(ts.busy) return;
+        if(ts.generation != gen) // first allocation on this thread since start()
+        {
+            ts.generation = gen;
+            ts.bytesUntilSample = nextInterval(ts);
+            return;
+        }
+        ts.busy = true;
+        ts.bytesUntilSample = nextInterval(ts);
+
+        void* frames[MaxDepth + 2];
+        int n = backtrace(frames, MaxDepth + 2);
+        const int skip = 2; // recordSample and the allocation hook that called it
+        size_t depth = n > skip ? static_cast<size_t>(n - skip) : 0;
+
+        // An allocation of `size` bytes is sampled with probability 1 - exp(-size / rate),
+        // so weighting by its inverse gives an unbiased estimate of the allocated bytes.
+        double r = static_cast<double>(rate.load(std::memory_order_relaxed));
+        double p = 1.0 - std::exp(-static_cast<double>(size) / r);
+        insert(frames + skip, depth, size / p, 1.0 / p);
+        samples.fetch_add(1, std::memory_order_relaxed);
+        ts.busy = false;
+    }
+
+    static void insert(void* const* frames, size_t depth, double bytes, double count)
+    {
+        uint64_t h = 1469598103934665603ull; // FNV-1a over the return addresses
+        for(size_t i = 0; i < depth; ++i)
+        {
+            h = (h ^ reinterpret_cast<uintptr_t>(frames[i])) * 1099511628211ull;
+        }
+        if(h == 0) h = 1;
+        lock();
+        for(size_t probe = 0; probe < MaxStacks; ++probe)
+        {
+            Stack& st = stacks[(h + probe) % MaxStacks];
+            if(st.depth != 0 && st.hash != h) continue;
+            if(st.depth == 0)
+            {
+                st.hash = h;
+                st.depth = depth;
+                std::memcpy(st.frames, frames, depth * sizeof(void*));
+            }
+            st.bytes += bytes;
+            st.count += count;
+            break;
+        } // a full table drops the sample rather than allocating
+        unlock();
+    }
+
+    // Sampling is rare, so a spin lock around the aggregation table is cheap enough.
+    static void lock() {while(tableLock.test_and_set(std::memory_order_acquire)) {}}
+    static void unlock() {tableLock.clear(std::memory_order_release);}
+
+    inline static std::atomic<bool> active{false};
+    inline static std::atomic<size_t> rate{512 * 1024};
+    inline static std::atomic<uint64_t> generation{0};
+    inline static std::atomic<uint64_t> samples{0};
+    inline static std::atomic_flag tableLock = ATOMIC_FLAG_INIT;
+    inline static Stack stacks[MaxStacks]{};
+};
+
+/*
+Why sample by bytes and not by allocation count?
+    Counting every Nth allocation misses large, rare allocations and is fooled by
+    periodic patterns. Sampling "the allocation that contains byte k*N" weighs each
+    allocation by its size, which is what memory profiles are about.
+
+Why draw the interval from an exponential distribution?
+    With a fixed N a program that allocates in a cycle of N bytes would always hit
+    the same call site. Exponential gaps make the sample points a Poisson process,
+    which is memoryless: every byte has the same chance of being sampled.
+
+Cost:
+    Almost all allocations only do `bytesUntilSample -= size`. The expensive
+    backtrace() happens once per ~SampleRate bytes (512 KiB by default), which
+    is why the profiler can stay on under real load, unlike the std::cout in
+    memalloc/main.cpp that runs on every single allocation.
+
+Symbols:
+    dladdr only sees exported symbols, so link with -rdynamic to get function
+    names from the executable itself. Anything else is printed as module+offset.
+*/
@@ -0,0 +1,305 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <execinfo.h>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+#include <vector>
+#include "heapprofiler.h" // symbolize()
+
+// Live-allocation tracker for finding leaks. While enabled, every allocation made
+// through the global hook (newhooks.h) is recorded with its size, a timestamp and
+// a call-site ID; every delete removes its record. Whatever is left when report()
+// runs (on demand, or at exit via reportAtExit()) is grouped by call site.
+//
+// Records live in a side table keyed by address, so blocks keep their normal
+// alignment and layout. The table is a lock-free open-addressing hash table:
+// inserts claim a slot with one CAS, removals turn the slot into a tombstone.
+//
+// Full tracking costs about 15 ns per new/delete pair: 17% of a loop that does
+// nothing but allocate, a few percent of a real program. To stay under 5% even
+// in that loop, enable(capacity, sampleOneIn) tracks only the blocks whose
+// address falls in a fixed 1-in-N subset; the others cost a multiply on new and
+// on delete. That finds the sites that keep leaking, but a single leaked block
+// is reported only with probability 1/N (item_13's one leaked Stock is likely
+// missed), and a site that leaked k blocks with probability 1 - (1 - 1/N)^k.
+
+class LeakTracker
+{
+public:
+    static constexpr size_t MaxCallSites = 4096;
+    static constexpr size_t StackDepth = 16;
+    static constexpr size_t MaxProbes = 64; // bounds every insert and lookup, tombstones or not
+    static constexpr unsigned ClockEvery = 64; // allocations per thread between two clock reads
+
+    // capacity: maximum number of simultaneously tracked blocks (rounded up to a power of two).
+    // sampleOneIn: track one block in that many (rounded up to a power of two). Both
+    // are fixed by the first call; later calls only switch tracking back on.
+    static void enable(size_t capacity = size_t{1} << 20, size_t sampleOneIn = 1)
+    {
+        if(!table.load(std::memory_order_acquire))
+        {
+            size_t cap = std::bit_ceil(capacity);
+            void* t = mmap(nullptr, cap * sizeof(Entry), PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if(t == MAP_FAILED) throw std::bad_alloc();
+            mask = cap - 1;
+            sampleMask = std::bit_ceil(std::max<size_t>(sampleOneIn, 1)) - 1;
+            startTime = now();
+            table.store(static_cast<Entry*>(t), std::memory_order_release); // zero-filled: every key is Empty
+        }
+        active.store(true, std::memory_order_release);
+    }
+
+    static void disable() {active.store(false, std::memory_order_release);}
+    static bool enabled() {return active.load(std::memory_order_relaxed);}
+
+    // Called from operator new with the return address of operator new itself.
+    static void onAllocate(void* memory, size_t size, void* caller)
+    {
+        if(active.load(std::memory_order_acquire) && sampled(reinterpret_cast<uintptr_t>(memory)))
+            record(memory, size, caller);
+    }
+
+    static void onFree(void* memory)
+    {
+        Entry* table = LeakTracker::table.load(std::memory_order_acquire);
+        if(!table) return; // removals continue after disable(), so records never go stale
+        uintptr_t key = reinterpret_cast<uintptr_t>(memory);
+        if(!sampled(key)) return;
+        for(size_t i = hash(key), probes = 0; probes < MaxProbes; i = (i + 1) & mask, ++probes)
+        {
+            uintptr_t k = table[i].key.load(std::memory_order_relaxed);
+            if(k == Empty) return; // allocated before enable(), or dropped
+            if(k == key)
+            {
+                table[i].key.store(Tombstone, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    // Surviving blocks grouped by call site, largest total first.
+    static void report(std::ostream& os = std::cerr)
+    {
+        Entry* table = LeakTracker::table.load(std::memory_order_acquire);
+        if(!table) return;
+        Suspend pause; // the report's own allocations are not leaks
+        struct Group {uint32_t site; size_t blocks; size_t bytes; uint64_t oldest;};
+        std::vector<Group> groups(MaxCallSites);
+        for(size_t i = 0; i < MaxCallSites; ++i) groups[i] = {static_cast<uint32_t>(i), 0, 0, 0};
+        uint64_t age = now() - startTime;
+        for(size_t i = 0; i <= mask; ++i)
+        {
+            // The acquire pairs with record()'s release: the fields of a published
+            // key are complete. If the key changed while we read them, the block
+            // was freed (and the slot maybe reused) meanwhile; skip it.
+            uintptr_t key = table[i].key.load(std::memory_order_acquire);
+            if(key <= Claimed) continue;
+            uint32_t site = table[i].site.load(std::memory_order_relaxed);
+            size_t size = table[i].size.load(std::memory_order_relaxed);
+            uint64_t time = table[i].time.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(table[i].key.load(std::memory_order_relaxed) != key) continue;
+            Group& g = groups[site];
+            ++g.blocks;
+            g.bytes += size;
+            g.oldest = std::max(g.oldest, age - std::min(age, time));
+        }
+        std::sort(groups.begin(), groups.end(), [](const Group& a, const Group& b){return a.bytes > b.bytes;});
+        size_t blocks = 0, bytes = 0;
+        for(const Group& g : groups)
+        {
+            if(g.blocks == 0) break;
+            blocks += g.blocks;
+            bytes += g.bytes;
+            os << g.bytes << " bytes in " << g.blocks << " block(s), oldest " << g.oldest / 1000000 << " ms, allocated at:\n";
+            const CallSite& cs = sites[g.site];
+            if(cs.caller.load(std::memory_order_acquire) <= Claimed) os << "    (stack still being captured)\n";
+            else for(size_t f = 0; f < cs.depth; ++f) os << "    " << symbolize(cs.frames[f]) << "\n";
+        }
+        os << "LeakTracker: " << bytes << " bytes in " << blocks << " live block(s)";
+        if(sampleMask) os << " (1 in " << sampleMask + 1 << " blocks sampled: sites that leaked only a few blocks may be missing)";
+        if(size_t d = dropped.load(std::memory_order_relaxed)) os << ", " << d << " not tracked (table too small)";
+        os << "\n";
+    }
+
+    static void reportAtExit() {std::atexit([]{report(std::cerr);});}
+
+private:
+    static constexpr uintptr_t Empty = 0;
+    static constexpr uintptr_t Tombstone = 1;
+    static constexpr uintptr_t Claimed = 2; // slot or call site being filled in; not published yet
+
+    // The fields are atomics only so that report() may read them while another
+    // thread writes; all accesses to them are relaxed, which costs nothing extra.
+    struct Entry
+    {
+        std::atomic<uintptr_t> key;
+        std::atomic<size_t> size;
+        std::atomic<uint64_t> time; // ns since enable()
+        std::atomic<uint32_t> site;
+    };
+
+    struct CallSite
+    {
+        std::atomic<uintptr_t> caller;
+        size_t depth;
+        void* frames[StackDepth];
+    };
+
+    [[gnu::noinline]] static void record(void* memory, size_t size, void* caller)
+    {
+        uintptr_t key = reinterpret_cast<uintptr_t>(memory);
+        if(suspended()) return;
+        Entry* table = LeakTracker::table.load(std::memory_order_relaxed);
+        uint32_t site = callSite(caller);
+        uint64_t time = timestamp();
+        for(size_t i = hash(key), probes = 0; probes < MaxProbes; i = (i + 1) & mask, ++probes)
+        {
+            uintptr_t k = table[i].key.load(std::memory_order_relaxed);
+            if(k > Tombstone) continue;
+            // Claim the slot, fill it in, then publish the key with a release
+            // store: whoever sees the key also sees the fields.
+            if(table[i].key.compare_exchange_strong(k, Claimed, std::memory_order_relaxed))
+            {
+                table[i].size.store(size, std::memory_order_relaxed);
+                table[i].time.store(time, std::memory_order_relaxed);
+                table[i].site.store(site, std::memory_order_relaxed);
+                table[i].key.store(key, std::memory_order_release);
+                return;
+            }
+        }
+        dropped.fetch_add(1, std::memory_order_relaxed); // neighbourhood full
+    }
+
+    struct Suspend
+    {
+        Suspend() {suspended() = true;}
+        ~Suspend() {suspended() = false;}
+    };
+
+    static bool& suspended()
+    {
+        thread_local bool flag = false;
+        return flag;
+    }
+
+    // Deliberately not a scrambling hash: blocks that are close in memory get slots
+    // that are close in the table, so the table inherits the allocator's locality
+    // instead of turning every new/delete into a cache miss.
+    static size_t hash(uintptr_t key) {return static_cast<size_t>(key >> 4) & mask;}
+
+    // Whether a block is tracked depends only on its address, so delete can tell
+    // without looking it up. The multiply mixes in the high bits: the low bits
+    // alone would pick blocks by their offset inside the allocator's pages.
+    static bool sampled(uintptr_t key) {return ((key >> 4) * 0x9E3779B97F4A7C15ull >> 40 & sampleMask) == 0;}
+
+    // The thread's clock, read on every ClockEvery-th allocation. A block's time
+    // may lag by that many of its thread's allocations, which only makes it look
+    // older; a leak's age is about seconds, not nanoseconds.
+    static uint64_t timestamp()
+    {
+        thread_local uint64_t stamp = 0;
+        thread_local unsigned untilRead = 0;
+        if(untilRead-- == 0)
+        {
+            stamp = now() - startTime;
+            untilRead = ClockEvery - 1;
+        }
+        return stamp;
+    }
+
+    // A coarse clock is enough to age leaks and costs a few ns instead of ~20.
+    static uint64_t now()
+    {
+#ifdef CLOCK_MONOTONIC_COARSE
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // Compact ID of the code that called operator new: the index of its return
+    // address in a small lock-free table. The first time an address shows up, a
+    // full backtrace is captured for the report; after that it is a lookup.
+    [[gnu::noinline]] static uint32_t callSite(void* caller)
+    {
+        uintptr_t key = reinterpret_cast<uintptr_t>(caller);
+        size_t start = static_cast<size_t>(key * 0x9E3779B97F4A7C15ull >> 52) % MaxCallSites;
+        for(size_t n = 0; n < MaxCallSites; ++n)
+        {
+            size_t i = (start + n) % MaxCallSites;
+            uintptr_t k = sites[i].caller.load(std::memory_order_acquire);
+            if(k == key) return static_cast<uint32_t>(i);
+            if(k != Empty) continue;
+            // Claim the slot, capture the stack, then publish the caller with a
+            // release store, as record() does for entries: report() only prints
+            // the frames of a published site. A thread that meets a Claimed slot
+            // moves on, so a call site seen by two threads at once may get two slots.
+            if(sites[i].caller.compare_exchange_strong(k, Claimed, std::memory_order_relaxed))
+            {
+                void* frames[StackDepth + 3];
+                int depth = backtrace(frames, StackDepth + 3);
+                const int skip = 3; // callSite, record and the allocation hook
+                sites[i].depth = depth > skip ? std::min<size_t>(depth - skip, StackDepth) : 0;
+                std::copy(frames + skip, frames + skip + sites[i].depth, sites[i].frames);
+                sites[i].caller.store(key, std::memory_order_release);
+                return static_cast<uint32_t>(i);
+            }
+            if(k == key) return static_cast<uint32_t>(i); // another thread registered it first
+        }
+        return 0; // table full: lump into the first site
+    }
+
+    inline static std::atomic<bool> active{false};
+    inline static std::atomic<Entry*> table{nullptr};
+    inline static size_t mask{0};
+    inline static uint64_t sampleMask{0};
+    inline static uint64_t startTime{0};
+    inline static std::atomic<size_t> dropped{0};
+    inline static CallSite sites[MaxCallSites]{};
+};
+
+/*
+Why a side table and not a header in front of each block?
+    A header shifts the block the user sees, so a 64-byte aligned request needs
+    64 bytes of padding and every free has to find its way back to the real start.
+    An address-keyed table leaves the blocks exactly as the allocator returned them.
+
+Why lock-free?
+    Every allocation of every thread goes through the tracker. A mutex around a
+    std::unordered_map would serialize the whole program and allocate while
+    holding it. Here an insert is a hash, a short probe and a single CAS.
+
+Why group by the immediate caller of operator new?
+    Its return address is free to obtain (__builtin_return_address(0)) and
+    identifies the line that allocated. The expensive backtrace() only runs the
+    first time a call site is seen, to show where it sits in the program.
+
+Cost:
+    With tracking disabled the hook pays one relaxed load. With it enabled, each
+    new/delete pair adds two short probes and a CAS; the clock is read once per
+    ClockEvery allocations. `./benchmark tracked 1` measures the worst case, a
+    loop that does nothing but new/delete: about 15 ns on 85, or 17%, of which
+    the CAS is a third and the rest is the lookups themselves. The 5% target is
+    met there only by `./benchmark sampled 1` (one block in 64, under 2%); full
+    tracking meets it in a program that spends under a third of its time in the
+    allocator. Use full tracking to find a particular leak, sampling to watch a
+    long-running service for sites that leak steadily.
+
+Why sample by address?
+    delete has to know whether the block was recorded. Deciding from the
+    address alone answers that without a lookup, so untracked blocks skip the
+    table on both sides. A counter or a random draw would have to be looked up.
+*/
@@ -1,44 +1,113 @@
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <string>
+#include <thread>
+#include <vector>
+#include "newhooks.h" // operator new/delete, reporting into AllocationMetrics and HeapProfiler
 
 
-class AllocationMetrics
-{
-public: 
-    static uint64_t CurrentUsage(){return TotalAllocated-TotalFreed;}
-    static void allocated(size_t size){TotalAllocated+=size;}
-    static void freed(size_t size){TotalFreed+=size;}
-private:
-    inline static uint64_t TotalAllocated{0};
-    inline static uint64_t TotalFreed{0};
-};
-
-
+// Usage is counted in bytes reserved by the allocator (see newhooks.h), so the
+// 12-byte Object shows up as the 24 bytes malloc really set aside for it.
 void PrintMemoryUsage()
 {
     std::cout << "Memory usage: " << AllocationMetrics::CurrentUsage() << "\n";
 }
 
-void* operator new(std::size_t size)
+void churn(int n)
 {
-    AllocationMetrics::allocated(size);
-    return malloc(size);
+    for(int i = 0; i < n; ++i)
+    {
+        std::vector<int> v(i % 100 + 1); // allocates on every iteration from several threads at once
+    }
 }
 
-void operator delete(void* memory, std::size_t size) noexcept
+std::vector<std::string> buildNames(int n)
 {
-    AllocationMetrics::freed(size);
-    free(memory);
+    std::vector<std::string> names;
+    for(int i = 0; i < n; ++i)
+    {
+        names.push_back("A name long enough to defeat the small string optimization #" + std::to_string(i));
+    }
+    return names;
 }
 
+std::map<int, std::vector<double>> buildIndex(int n)
+{
+    std::map<int, std::vector<double>> index;
+    for(int i = 0; i < n; ++i)
+    {
+        index[i].resize(64);
+    }
+    return index;
+}
 
 struct Object
 {
     int x, y, z;
 };
 
+class Chatty // from item_16
+{
+public:
+    Chatty(){std::cout << "Constructor called!\n";}
+    ~Chatty(){std::cout << "Destructor called!\n";}
+};
+
+struct alignas(64) CacheLine
+{
+    double values[8];
+};
+
+// Every form of new/delete must leave the metrics where they started.
+void check(const char* form, uint64_t before)
+{
+    uint64_t after = AllocationMetrics::CurrentUsage();
+    std::cout << (after == before ? "ok    " : "DRIFT ") << form << "\n";
+}
+
+void exerciseAllForms()
+{
+    uint64_t base = AllocationMetrics::CurrentUsage();
+
+    delete new Object;                                             check("new / sized delete", base);
+    ::operator delete(::operator new(24));                         check("new / unsized delete", base);
+    Chatty* parrc = new Chatty[3]; delete[] parrc;                 check("new[] / delete[] (Chatty[3])", base);
+    int* ints = new int[100]; delete[] ints;                       check("new[] / delete[] (trivial type)", base);
+    delete new (std::nothrow) Object;                              check("nothrow new / delete", base);
+    delete[] new (std::nothrow) int[10];                           check("nothrow new[] / delete[]", base);
+    ::operator delete(::operator new(8, std::nothrow), std::nothrow); check("nothrow new / nothrow delete", base);
+
+    CacheLine* line = new CacheLine;
+    std::cout << "      alignas(64) new is 64-byte aligned: " << (reinterpret_cast<uintptr_t>(line) % 64 == 0) << "\n";
+    delete line;                                                   check("aligned new / aligned sized delete", base);
+    delete[] new CacheLine[4];                                     check("aligned new[] / aligned delete[]", base);
+    void* p = ::operator new(100, std::align_val_t{128});
+    ::operator delete(p, std::align_val_t{128});                   check("aligned new / aligned unsized delete", base);
+    p = ::operator new(100, std::align_val_t{256}, std::nothrow);
+    ::operator delete(p, std::align_val_t{256}, std::nothrow);     check("aligned nothrow new / delete", base);
+    p = ::operator new[](100, std::align_val_t{32}, std::nothrow);
+    ::operator delete[](p, std::align_val_t{32}, std::nothrow);    check("aligned nothrow new[] / delete[]", base);
+
+    CacheLineAlignment::enable(4096);
+    {
+        std::vector<char> big(10000);
+        std::cout << "      cache-line mode, 10000-byte buffer 64-byte aligned: "
+                  << (reinterpret_cast<uintptr_t>(big.data()) % 64 == 0) << "\n";
+    }
+    CacheLineAlignment::disable();                                 check("cache-line aligned vector", base);
+
+    SlabAllocator::enable();
+    delete[] new Chatty[3];                                        check("slab new[] / delete[]", base);
+    ::operator delete(::operator new(40));                         check("slab new / unsized delete", base);
+    SlabAllocator::disable();
+}
+
 int main()
 {
+    AllocationMetrics::trackExactPeak(true); // a demo: exact numbers matter more than speed
+    LeakTracker::enable();
+    LeakTracker::reportAtExit(); // obj below is never deleted
     Object* obj = new Object;
     PrintMemoryUsage();
     std::string name = "Matias";
@@ -49,10 +118,50 @@ int main()
     }
     PrintMemoryUsage();
     obj->x = 1;
+
+    exerciseAllForms();
+
+    {
+        std::string longname = "This is a really long string that will likely exceed the SSO buffer and trigger allocation.";
+        std::string shortname = "Matias";
+        NoAllocScope guard; // Record mode: count, don't abort
+        std::string moved = std::move(longname); // steals the buffer
+        std::string copied = shortname;         // fits in the SSO buffer
+        std::cout << "Allocations in the no-alloc scope so far: " << guard.violations() << "\n";
+        std::string copiedLong = moved;         // a real allocation
+        std::cout << "Allocations in the no-alloc scope: " << guard.violations()
+                  << " (" << guard.bytes() << " bytes)\n";
+    }
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; ++t) threads.emplace_back(churn, 100000);
+    for(auto& th : threads) th.join();
+    PrintMemoryUsage(); // the sharded counters agree with the single-threaded result above
+    AllocationMetrics::print();
+
+    // Sampling heap profiler: one backtrace every ~64 KiB allocated.
+    HeapProfiler::start(64 * 1024);
+    for(int round = 0; round < 20; ++round)
+    {
+        auto names = buildNames(2000);
+        auto index = buildIndex(1000);
+    }
+    HeapProfiler::stop();
+    std::cout << "Heap profiler took " << HeapProfiler::sampleCount() << " samples\n";
+    std::ofstream folded("heap.folded");
+    HeapProfiler::dumpFolded(folded); // flamegraph.pl heap.folded > heap.svg
+
+    // From here on small objects come from the size-class slabs (see benchmark.cpp).
+    SlabAllocator::enable();
+    threads.clear();
+    for(int t = 0; t < 4; ++t) threads.emplace_back(churn, 100000);
+    for(auto& th : threads) th.join();
+    std::cout << "Slab spans in use: " << SlabAllocator::spansInUse() << "\n";
+    PrintMemoryUsage(); // still reported through AllocationMetrics
     return 0;
 }
 
-// AllocationMetrics uses only static methods and data.
+// AllocationMetrics (see allocationmetrics.h) uses only static methods and data.
 // No instance of the class is ever created.
 // Static data (TotalAllocated/Freed) is shared globally across the program.
 // Static methods can be called via class name without any object.
@@ -63,6 +172,25 @@ int main()
 // All members used are static, accessed via the class itself.
 // Constructors only run when an object is constructed — which we never do.
 
+/*
+The first version of this example kept two plain counters:
+
+class AllocationMetrics
+{
+public: 
+    static uint64_t CurrentUsage(){return TotalAllocated-TotalFreed;}
+    static void allocated(size_t size){TotalAllocated+=size;}
+    static void freed(size_t size){TotalFreed+=size;}
+private:
+    inline static uint64_t TotalAllocated{0};
+    inline static uint64_t TotalFreed{0};
+};
+
+That is a data race as soon as two threads allocate: `TotalAllocated += size` is a
+read-modify-write, and concurrent updates get lost. allocationmetrics.h keeps one
+counter set per thread (sharded) and merges them when read.
+*/
+
 /*
 Old C++ (before C++17)
 
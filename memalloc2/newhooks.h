@@ -0,0 +1,176 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+#include "allocationmetrics.h"
+#include "arena.h"
+#include "heapprofiler.h"
+#include "leaktracker.h"
+#include "noallocscope.h"
+#include "slaballocator.h"
+
+// Replacement global allocation functions. Each one must be defined exactly once
+// in the program, so include this header from a single translation unit (main.cpp).
+// Memory comes from the innermost ArenaScope of the calling thread if there is one,
+// otherwise from malloc, or from SlabAllocator once SlabAllocator::enable() was called.
+//
+// Every replaceable form is covered (single/array, aligned, nothrow, sized and
+// unsized delete), and all of them funnel into NewHooks::allocate/deallocate.
+// AllocationMetrics counts the bytes the allocator actually reserved for a block
+// (malloc_usable_size, or the slab size class). Unlike the requested size, that
+// number can be recovered from the pointer alone, so unsized deletes are counted
+// exactly and the metrics cannot drift.
+
+// Opt-in: blocks of at least `threshold` bytes are aligned to a 64-byte cache line,
+// so large buffers never share their first or last line with a neighbour.
+class CacheLineAlignment
+{
+public:
+    static constexpr size_t LineSize = 64;
+    static void enable(size_t threshold) {minSize.store(threshold, std::memory_order_relaxed);}
+    static void disable() {minSize.store(SIZE_MAX, std::memory_order_relaxed);}
+    static size_t threshold() {return minSize.load(std::memory_order_relaxed);}
+private:
+    inline static std::atomic<size_t> minSize{SIZE_MAX};
+};
+
+namespace NewHooks
+{
+
+inline size_t allocatedSize(void* memory)
+{
+    if(SlabAllocator::owns(memory)) return SlabAllocator::allocatedSize(memory);
+#ifdef __APPLE__
+    return malloc_size(memory);
+#else
+    return malloc_usable_size(memory);
+#endif
+}
+
+// Returns nullptr on failure; the operators below decide whether to throw.
+// `caller` is the return address of the operator new that was called.
+inline void* tryAllocate(size_t size, size_t alignment, void* caller)
+{
+    NoAllocScope::onAllocate(size, caller);
+    alignment = std::max(alignment, size_t{__STDCPP_DEFAULT_NEW_ALIGNMENT__});
+    if(size == 0) size = 1; // every new must return a distinct pointer, arena or not
+    if(ArenaScope* scope = ArenaScope::current()) return scope->resource().allocateBytes(size, alignment);
+    if(size >= CacheLineAlignment::threshold()) alignment = std::max(alignment, CacheLineAlignment::LineSize);
+
+    void* memory = nullptr;
+    if(alignment <= SlabAllocator::Alignment)
+    {
+        if(SlabAllocator::enabled()) memory = SlabAllocator::allocate(size);
+        if(!memory) memory = malloc(size);
+    }
+    else if(posix_memalign(&memory, alignment, size) != 0)
+    {
+        memory = nullptr;
+    }
+    if(!memory) return nullptr;
+    AllocationMetrics::allocated(allocatedSize(memory));
+    HeapProfiler::sampleAllocation(size);
+    LeakTracker::onAllocate(memory, size, caller);
+    return memory;
+}
+
+// The standard contract of the throwing forms: keep calling the new_handler until
+// it either frees some memory or gives up (no handler left -> std::bad_alloc).
+inline void* allocate(size_t size, size_t alignment, void* caller)
+{
+    for(;;)
+    {
+        if(void* memory = tryAllocate(size, alignment, caller)) return memory;
+        std::new_handler handler = std::get_new_handler();
+        if(!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+inline void* allocateNothrow(size_t size, size_t alignment, void* caller) noexcept
+{
+    try
+    {
+        return allocate(size, alignment, caller);
+    }
+    catch(...)
+    {
+        return nullptr;
+    }
+}
+
+// The size and alignment arguments of the sized/aligned deletes are not needed:
+// the pointer alone says which allocator owns it and how big the block is.
+inline void deallocate(void* memory) noexcept
+{
+    if(!memory) return;
+    if(ArenaScope::deallocate(memory)) return;
+    LeakTracker::onFree(memory);
+    AllocationMetrics::freed(allocatedSize(memory));
+    if(SlabAllocator::owns(memory)) SlabAllocator::deallocate(memory); // even after disable()
+    else free(memory);
+}
+
+} // namespace NewHooks
+
+#define NEWHOOKS_CALLER __builtin_return_address(0) // the code that called operator new
+
+// new / new[]
+void* operator new(std::size_t size) {return NewHooks::allocate(size, 0, NEWHOOKS_CALLER);}
+void* operator new[](std::size_t size) {return NewHooks::allocate(size, 0, NEWHOOKS_CALLER);}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {return NewHooks::allocateNothrow(size, 0, NEWHOOKS_CALLER);}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {return NewHooks::allocateNothrow(size, 0, NEWHOOKS_CALLER);}
+
+// aligned new / new[] (used automatically for over-aligned types, e.g. alignas(64))
+void* operator new(std::size_t size, std::align_val_t al)
+{
+    return NewHooks::allocate(size, static_cast<size_t>(al), NEWHOOKS_CALLER);
+}
+void* operator new[](std::size_t size, std::align_val_t al)
+{
+    return NewHooks::allocate(size, static_cast<size_t>(al), NEWHOOKS_CALLER);
+}
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return NewHooks::allocateNothrow(size, static_cast<size_t>(al), NEWHOOKS_CALLER);
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return NewHooks::allocateNothrow(size, static_cast<size_t>(al), NEWHOOKS_CALLER);
+}
+
+// delete / delete[]: unsized, sized, nothrow (called when a constructor throws after nothrow new)
+void operator delete(void* memory) noexcept {NewHooks::deallocate(memory);}
+void operator delete[](void* memory) noexcept {NewHooks::deallocate(memory);}
+void operator delete(void* memory, std::size_t) noexcept {NewHooks::deallocate(memory);}
+void operator delete[](void* memory, std::size_t) noexcept {NewHooks::deallocate(memory);}
+void operator delete(void* memory, const std::nothrow_t&) noexcept {NewHooks::deallocate(memory);}
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {NewHooks::deallocate(memory);}
+
+// aligned delete / delete[]
+void operator delete(void* memory, std::align_val_t) noexcept {NewHooks::deallocate(memory);}
+void operator delete[](void* memory, std::align_val_t) noexcept {NewHooks::deallocate(memory);}
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {NewHooks::deallocate(memory);}
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {NewHooks::deallocate(memory);}
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept {NewHooks::deallocate(memory);}
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept {NewHooks::deallocate(memory);}
+
+/*
+Why replace all of them?
+    The forms are independent replacement points. The defaults of new[], the
+    nothrow and the aligned forms do not necessarily call our operator new(size_t)
+    (aligned new goes straight to aligned_alloc in libstdc++), and the default
+    deletes call free() directly. Overriding only one pair means some allocations
+    are never counted while their frees are, or the other way round.
+
+Why does the cache-line mode not apply to arena allocations?
+    Inside an ArenaScope allocations are meant to be packed together; padding them
+    to 64 bytes would defeat the purpose. Explicitly over-aligned requests are
+    still honoured there.
+*/
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <unistd.h>
+
+// Marks a region of code as allocation-free for the current thread. Any operator
+// new on this thread while a NoAllocScope is alive (see newhooks.h) is either
+// recorded in the innermost scope or aborts the program on the spot, with the
+// offending size and return address on stderr. Other threads are unaffected.
+//
+//     {
+//         NoAllocScope guard(NoAllocScope::Mode::Abort);
+//         EntityMov e(std::move(name)); // must only steal the buffer
+//     }
+//
+// With no scope active the hook pays a single thread-local load.
+
+class NoAllocScope
+{
+public:
+    enum class Mode {Record, Abort};
+
+    explicit NoAllocScope(Mode mode_ = Mode::Record) : mode{mode_}, previous{top()} {top() = this;}
+    NoAllocScope(const NoAllocScope&) = delete;
+    NoAllocScope& operator=(const NoAllocScope&) = delete;
+    ~NoAllocScope() {top() = previous;}
+
+    size_t violations() const {return count;}
+    size_t bytes() const {return total;}
+    const void* firstCaller() const {return first;}
+
+    // Called from operator new with the return address of operator new itself.
+    static void onAllocate(size_t size, const void* caller)
+    {
+        if(NoAllocScope* scope = top()) scope->violate(size, caller);
+    }
+
+private:
+    [[gnu::noinline]] void violate(size_t size, const void* caller)
+    {
+        if(mode == Mode::Abort) fail(size, caller);
+        if(count++ == 0) first = caller;
+        total += size;
+    }
+
+    // No iostreams here: they might allocate, and we are inside operator new.
+    [[noreturn]] static void fail(size_t size, const void* caller)
+    {
+        char buf[96] = "NoAllocScope: allocation of ";
+        size_t n = 28;
+        n = append(buf, n, size, 10);
+        const char mid[] = " bytes from 0x";
+        for(char c : mid) if(c) buf[n++] = c;
+        n = append(buf, n, reinterpret_cast<uintptr_t>(caller), 16);
+        buf[n++] = '\n';
+        ssize_t ignored = write(STDERR_FILENO, buf, n);
+        (void)ignored;
+        std::abort();
+    }
+
+    static size_t append(char* buf, size_t n, uint64_t value, unsigned base)
+    {
+        char digits[20];
+        size_t d = 0;
+        do
+        {
+            digits[d++] = "0123456789abcdef"[value % base];
+            value /= base;
+        } while(value);
+        while(d) buf[n++] = digits[--d];
+        return n;
+    }
+
+    static NoAllocScope*& top()
+    {
+        thread_local NoAllocScope* scope = nullptr;
+        return scope;
+    }
+
+    Mode mode;
+    NoAllocScope* previous;
+    size_t count{0};
+    size_t total{0};
+    const void* first{nullptr};
+};
+
+/*
+Why per-thread?
+    "This code path does not allocate" is a property of one thread's execution.
+    A global flag would blame the hot path for allocations made concurrently by a
+    logger or another worker thread.
+
+Why can it abort?
+    In a test, aborting at the exact allocation gives a core dump / debugger stop
+    with the offending call stack. Record mode is for production-like runs where
+    we would rather count and report than crash.
+
+Note that deallocation is allowed inside a scope: destroying objects is usually
+fine on hot paths, and the objects being moved from were created outside.
+*/
@@ -0,0 +1,283 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+
+// Size-class slab allocator with per-thread caches, in the spirit of tcmalloc and
+// mimalloc, meant to sit behind the global operator new (see newhooks.h).
+//
+//   * Small requests (<= MaxSmallSize) are rounded up to one of NumClasses size
+//     classes. Larger requests go to malloc.
+//   * All slabs come from one virtual address range reserved up front, so
+//     "is this pointer ours?" is a range check and the size class of any pointer
+//     is a table lookup on its span index (no per-object header).
+//   * Each thread keeps a free list per size class and only talks to the shared
+//     central lists in batches, so the common new/delete touches no shared state.
+
+// Shared free list of one size class, on its own cache line.
+struct alignas(64) SlabCentralList
+{
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;
+    void* head{nullptr};
+};
+
+class SlabAllocator
+{
+public:
+    static constexpr size_t MaxSmallSize = 32 * 1024;
+    static constexpr size_t NumClasses = 84;
+    static constexpr size_t SpanSize = 256 * 1024;
+    static constexpr size_t RegionSize = size_t{4} << 30; // address space only, pages are touched lazily
+    static constexpr size_t NumSpans = RegionSize / SpanSize;
+    static constexpr size_t Alignment = 16;
+
+    static void enable() {init(); active.store(true, std::memory_order_release);}
+    static void disable() {active.store(false, std::memory_order_release);}
+    static bool enabled() {return active.load(std::memory_order_relaxed);}
+
+    static bool owns(const void* p)
+    {
+        uintptr_t b = regionBase.load(std::memory_order_relaxed);
+        return b != 0 && reinterpret_cast<uintptr_t>(p) - b < RegionSize;
+    }
+
+    // Returns nullptr for sizes the slabs do not serve (the caller falls back to malloc).
+    static void* allocate(size_t size)
+    {
+        if(size > MaxSmallSize) return nullptr;
+        size_t cls = sizeClass(size);
+        ThreadCache* tc = threadCache();
+        if(tc)
+        {
+            FreeList& fl = tc->lists[cls];
+            if(!fl.head) refill(fl, cls);
+            void* p = fl.head;
+            if(p)
+            {
+                fl.head = *static_cast<void**>(p);
+                --fl.count;
+            }
+            return p;
+        }
+        return popCentral(cls); // thread is shutting down
+    }
+
+    static void deallocate(void* p)
+    {
+        size_t cls = spanClass[spanIndex(p)];
+        ThreadCache* tc = threadCache();
+        if(!tc)
+        {
+            pushCentral(cls, p, p);
+            return;
+        }
+        FreeList& fl = tc->lists[cls];
+        *static_cast<void**>(p) = fl.head;
+        fl.head = p;
+        if(++fl.count > 2 * batchSize(cls)) release(fl, cls, batchSize(cls));
+    }
+
+    // Bytes actually reserved for a pointer returned by allocate().
+    static size_t allocatedSize(const void* p) {return classSize(spanClass[spanIndex(p)]);}
+
+    static constexpr size_t classSize(size_t cls)
+    {
+        if(cls < 64) return (cls + 1) * 16;               // 16, 32, ..., 1024
+        size_t k = cls - 64;
+        size_t b = 11 + k / 4;                            // (2^(b-1), 2^b] split into quarters
+        return (size_t{1} << (b - 1)) + (k % 4 + 1) * (size_t{1} << (b - 3));
+    }
+
+    static constexpr size_t sizeClass(size_t size)
+    {
+        if(size <= 1024) return size == 0 ? 0 : (size - 1) / 16;
+        size_t b = std::bit_width(size - 1);
+        return 64 + (b - 11) * 4 + ((size - 1 - (size_t{1} << (b - 1))) >> (b - 3));
+    }
+
+    static uint64_t spansInUse() {return nextSpan.load(std::memory_order_relaxed);}
+
+private:
+    struct FreeList
+    {
+        void* head{nullptr};
+        size_t count{0};
+    };
+
+    using CentralList = SlabCentralList;
+
+    struct ThreadCache
+    {
+        FreeList lists[NumClasses];
+        ~ThreadCache()
+        {
+            for(size_t cls = 0; cls < NumClasses; ++cls)
+            {
+                if(lists[cls].count) release(lists[cls], cls, lists[cls].count);
+            }
+            cacheState() = Dead;
+        }
+    };
+
+    enum CacheState : uint8_t {Unused, Alive, Dead};
+
+    static CacheState& cacheState()
+    {
+        thread_local CacheState state = Unused;
+        return state;
+    }
+
+    // The cache itself has a destructor (it hands its objects back to the central
+    // lists at thread exit), so a separate trivially destructible flag tells us
+    // whether it may still be used.
+    static ThreadCache* threadCache()
+    {
+        CacheState& state = cacheState();
+        if(state == Dead) return nullptr;
+        thread_local ThreadCache cache;
+        state = Alive;
+        return &cache;
+    }
+
+    // Move objects between a thread and the central lists in batches of ~64 KiB.
+    static constexpr size_t batchSize(size_t cls)
+    {
+        size_t n = (64 * 1024) / classSize(cls);
+        return n < 2 ? 2 : (n > 64 ? 64 : n);
+    }
+
+    static void refill(FreeList& fl, size_t cls)
+    {
+        size_t want = batchSize(cls);
+        CentralList& c = central[cls];
+        lock(c);
+        while(fl.count < want && c.head)
+        {
+            void* p = c.head;
+            c.head = *static_cast<void**>(p);
+            *static_cast<void**>(p) = fl.head;
+            fl.head = p;
+            ++fl.count;
+        }
+        unlock(c);
+        if(fl.count == 0) carveSpan(fl, cls);
+    }
+
+    static void release(FreeList& fl, size_t cls, size_t n)
+    {
+        void* first = fl.head;
+        void* last = first;
+        for(size_t i = 1; i < n; ++i) last = *static_cast<void**>(last);
+        fl.head = *static_cast<void**>(last);
+        fl.count -= n;
+        pushCentral(cls, first, last);
+    }
+
+    static void pushCentral(size_t cls, void* first, void* last)
+    {
+        CentralList& c = central[cls];
+        lock(c);
+        *static_cast<void**>(last) = c.head;
+        c.head = first;
+        unlock(c);
+    }
+
+    static void* popCentral(size_t cls)
+    {
+        CentralList& c = central[cls];
+        lock(c);
+        void* p = c.head;
+        if(p) c.head = *static_cast<void**>(p);
+        unlock(c);
+        if(p) return p;
+        FreeList fl;
+        carveSpan(fl, cls);
+        if(!fl.head) return nullptr;
+        p = fl.head;
+        if(fl.count > 1) pushCentral(cls, *static_cast<void**>(p), lastOf(fl));
+        return p;
+    }
+
+    static void* lastOf(const FreeList& fl)
+    {
+        void* p = fl.head;
+        while(*static_cast<void**>(p)) p = *static_cast<void**>(p);
+        return p;
+    }
+
+    // Takes a fresh span from the region and threads all its objects onto `fl`.
+    static void carveSpan(FreeList& fl, size_t cls)
+    {
+        size_t span = nextSpan.fetch_add(1, std::memory_order_relaxed);
+        if(span >= NumSpans) return; // region exhausted: allocate() returns nullptr
+        spanClass[span] = static_cast<uint8_t>(cls);
+        char* base = reinterpret_cast<char*>(regionBase.load(std::memory_order_relaxed) + span * SpanSize);
+        size_t size = classSize(cls);
+        size_t n = SpanSize / size;
+        for(size_t i = n; i-- > 0;)
+        {
+            void* p = base + i * size;
+            *static_cast<void**>(p) = fl.head;
+            fl.head = p;
+        }
+        fl.count += n;
+    }
+
+    static size_t spanIndex(const void* p)
+    {
+        return (reinterpret_cast<uintptr_t>(p) - regionBase.load(std::memory_order_relaxed)) / SpanSize;
+    }
+
+    static void init()
+    {
+        if(regionBase.load(std::memory_order_acquire)) return;
+        void* r = mmap(nullptr, RegionSize, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if(r == MAP_FAILED) throw std::bad_alloc();
+        uintptr_t expected = 0;
+        if(!regionBase.compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(r)))
+        {
+            munmap(r, RegionSize); // another thread won the race
+        }
+    }
+
+    static void lock(CentralList& c) {while(c.lock.test_and_set(std::memory_order_acquire)) {}}
+    static void unlock(CentralList& c) {c.lock.clear(std::memory_order_release);}
+
+    inline static std::atomic<bool> active{false};
+    inline static std::atomic<uintptr_t> regionBase{0};
+    inline static std::atomic<size_t> nextSpan{0};
+    inline static uint8_t spanClass[NumSpans]{};
+    inline static CentralList central[NumClasses];
+};
+
+static_assert(SlabAllocator::classSize(SlabAllocator::NumClasses - 1) == SlabAllocator::MaxSmallSize);
+static_assert(SlabAllocator::sizeClass(SlabAllocator::MaxSmallSize) == SlabAllocator::NumClasses - 1);
+static_assert(SlabAllocator::sizeClass(1025) == 64 && SlabAllocator::classSize(64) == 1280);
+
+/*
+Why size classes?
+    Rounding every request up to one of a few dozen sizes means a freed block can
+    be reused by any later request of the same class, without searching or
+    splitting. The price is internal fragmentation: at most 1/16 for tiny objects
+    and about 1/4 above 1 KiB.
+
+Why per-thread caches?
+    malloc implementations protect their arenas with locks. Here each thread owns a
+    private free list per class: new is "pop the head", delete is "push the head",
+    with no atomic instruction at all. Threads only meet at the central lists, and
+    then they move a whole batch of objects per lock acquisition.
+
+Why one reserved region?
+    Freeing needs to know which allocator (slab or malloc) owns a pointer and which
+    class it belongs to. Reserving all slab memory as one address range turns both
+    questions into arithmetic, with no header in front of every object.
+
+Limitation:
+    Memory that went into the slabs is kept for reuse and never returned to the OS,
+    as in most thread-caching allocators without a background scavenger.
+*/
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "heapstring.h"
+#include "ssostring.h"
+
+// Construct / copy / move throughput of the heap-only HeapString versus the SSO
+// String, for a short name that fits inline and a long one that does not.
+// Build with -DSTRING_TRACE=0 (the Makefile does), or the tracing dominates.
+
+using Clock = std::chrono::steady_clock;
+
+template <typename S>
+size_t consume(const S& s) {return s.Size() + static_cast<unsigned char>(s.Data()[0]);}
+
+template <typename S, typename F>
+double nsPerOp(const char* text, size_t n, F&& op)
+{
+    std::vector<S> pool;
+    pool.reserve(64);
+    for(int i = 0; i < 64; ++i) pool.emplace_back(text);
+    size_t sink = 0;
+    auto t0 = Clock::now();
+    for(size_t i = 0; i < n; ++i) sink += op(pool[i & 63]);
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / n;
+    if(sink == 42) std::puts(""); // keep the work observable
+    return ns;
+}
+
+template <typename S>
+void run(const char* name, const char* text, size_t n)
+{
+    double construct = nsPerOp<S>(text, n, [&](S&){S s(text); return consume(s);});
+    double copy = nsPerOp<S>(text, n, [](S& src){S s(src); return consume(s);});
+    double move = nsPerOp<S>(text, n, [](S& src){S s(std::move(src)); size_t r = consume(s); src = std::move(s); return r;});
+    std::printf("%-11s %-6s construct %6.2f ns   copy %6.2f ns   move+move back %6.2f ns\n",
+                name, std::strlen(text) <= String::InlineCapacity ? "short" : "long", construct, copy, move);
+}
+
+// Grows a std::vector to `n` elements with push_back and counts what happened to
+// the elements already inside whenever the vector reallocated.
+template <typename S>
+void grow(const char* name, const char* text, size_t n)
+{
+    StringCounters::Reset();
+    auto t0 = Clock::now();
+    {
+        std::vector<S> v;
+        for(size_t i = 0; i < n; ++i) v.push_back(S(text));
+    }
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    std::printf("%-11s %-6s grow to %zu: %8.1f ms   copies %9zu   moves %9zu\n",
+                name, std::strlen(text) <= String::InlineCapacity ? "short" : "long", n, ms,
+                StringCounters::Copied, StringCounters::Moved);
+}
+
+int main()
+{
+    constexpr size_t N = 20'000'000;
+    const char* shortName = "Matias";
+    const char* longName = "Matias, a name long enough to live on the heap";
+    run<HeapString>("HeapString", shortName, N);
+    run<String>("String", shortName, N);
+    run<HeapString>("HeapString", longName, N);
+    run<String>("String", longName, N);
+
+    constexpr size_t M = 1'000'000;
+    std::printf("\n");
+    grow<HeapString>("HeapString", shortName, M);
+    grow<String>("String", shortName, M);
+    grow<HeapString>("HeapString", longName, M);
+    grow<String>("String", longName, M);
+}
+
+/*
+What to expect:
+    Short strings: HeapString pays new/delete for every construction and copy,
+    String only copies a few bytes, typically an order of magnitude faster.
+    Long strings: both allocate, so construct/copy cost the same.
+    Moves: HeapString steals a pointer. String does the same for long strings but
+    has to copy the inline bytes for short ones, which is still only a few ns.
+
+    Growing a vector to 1M elements: every push_back moves one temporary in (1M
+    moves for both). On top of that, each reallocation transfers the existing
+    elements, about 1M more in total with doubling growth. HeapString's move
+    constructor is not noexcept, so the vector copies them instead (~1M copies,
+    each one a new/delete for long strings); String's noexcept move is used, so
+    the copy count is 0.
+*/
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include "stringtrace.h"
+
+// The original, heap-only String of this example: every construction and copy
+// allocates, even for a 6-character name. Kept as the baseline for benchmark.cpp.
+// Its move constructor is deliberately left without noexcept, as it was, so the
+// benchmark can show what that costs inside a std::vector.
+class HeapString
+{
+public:
+    HeapString() = default;
+
+    HeapString(const char* string)
+    {
+        STRING_LOG("Created!\n");
+        STRING_COUNT(Created);
+        m_Size = strlen(string);
+        m_Data = new char[m_Size];
+        memcpy(m_Data,string, m_Size);
+    }
+
+    HeapString(const HeapString& other)
+    {
+        STRING_LOG("Copied!\n");
+        STRING_COUNT(Copied);
+        m_Size = other.m_Size;
+        m_Data = new char[m_Size];
+        memcpy(m_Data,other.m_Data, m_Size);
+    }
+
+    HeapString(HeapString&& other)
+    {
+        STRING_LOG("Moved!\n");
+        STRING_COUNT(Moved);
+        m_Size = other.m_Size;
+        m_Data = other.m_Data;
+        other.m_Size = 0;
+        other.m_Data = nullptr;
+    }
+
+    HeapString& operator=(HeapString&& other)
+    {
+        if(this != &other)
+        {
+            STRING_LOG("Moved!\n");
+            STRING_COUNT(Moved);
+            delete[] m_Data;
+            m_Size = other.m_Size;
+            m_Data = other.m_Data;
+            other.m_Size = 0;
+            other.m_Data = nullptr;
+        }
+        return *this;
+    }
+
+    ~HeapString()
+    {
+        STRING_LOG("Destroyed!\n");
+        delete[] m_Data;
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+
+    const char* Data() const {return m_Data;}
+    uint32_t Size() const {return m_Size;}
+
+    void Print() const
+    {
+        for(uint32_t i = 0; i < m_Size; ++i)
+        {
+            std::cout << m_Data[i];
+        }
+        std::cout << "\n";
+    }
+
+private:
+    char* m_Data{nullptr};
+    uint32_t m_Size{0};
+};
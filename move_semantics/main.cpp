@@ -1,71 +1,12 @@
 #include <iostream>
 #include <cstring>
+#include "ssostring.h" // String, with the small string optimization (heapstring.h has the original)
 
-class String
-{
-public:
-    String() = default;
-
-    String(const char* string)
-    {
-        std::cout << "Created!\n";
-        m_Size = strlen(string);
-        m_Data = new char[m_Size];
-        memcpy(m_Data,string, m_Size);
-    }
-
-    String(const String& other)
-    {
-        std::cout << "Copied!\n";
-        m_Size = other.m_Size;
-        m_Data = new char[m_Size];
-        memcpy(m_Data,other.m_Data, m_Size);
-    }
-
-    String(String&& other)
-    {
-        std::cout << "Moved!\n";
-        m_Size = other.m_Size;
-        m_Data = other.m_Data;
-        other.m_Size = 0;
-        other.m_Data = nullptr;
-    }
-
-    String& operator=(String&& other)
-    {
-        if(this != &other)
-        {
-            std::cout << "Moved!\n";
-            delete[] m_Data;
-            m_Size = other.m_Size;
-            m_Data = other.m_Data;
-            other.m_Size = 0;
-            other.m_Data = nullptr;
-        }
-        return *this;
-    }
-
-    ~String()
-    {
-        std::cout << "Destroyed!\n";
-        delete[] m_Data;
-        m_Data = nullptr;
-        m_Size = 0;
-    }
-
-    void Print() const
-    {
-        for(uint32_t i = 0; i < m_Size; ++i)
-        {
-            std::cout << m_Data[i];
-        }
-        std::cout << "\n";
-    }
-
-private:
-    char* m_Data;
-    uint32_t m_Size;
-};
+#ifdef CHECK_NOALLOC
+// g++ -std=c++20 -DCHECK_NOALLOC main.cpp && ./a.out
+// Aborts if EntityMov(String&&) touches the heap (see memalloc2/noallocscope.h).
+#include "../memalloc2/newhooks.h"
+#endif
 
 class EntityCopy
 {
@@ -161,6 +102,17 @@ int main()
     }
     std::cout << "Out of fourth scope\n";
 
+#ifdef CHECK_NOALLOC
+    {
+        // Longer than the 22 inline characters, so the move has a heap buffer to steal.
+        String name("Matias, a name too long for the small buffer"); // allocates, outside the guarded region
+        NoAllocScope guard(NoAllocScope::Mode::Abort);
+        EntityMov myEntityMov(std::move(name)); // must only steal the buffer
+        myEntityMov.PrintName();
+    }
+    std::cout << "EntityMov(String&&) did not allocate\n";
+#endif
+
     String string = "Hello";
     String dest = "Matias";
     std::cout << "string: ";
@@ -177,6 +129,15 @@ int main()
 
 /* Move semantics eliminate the need of using References or Pointers to transfer data without copying it. */
 
+/*
+    String started out as a heap-only class (now HeapString in heapstring.h): even
+    "Matias" cost a `new char[6]` on construction and on every copy. ssostring.h keeps
+    strings of up to 22 characters inside the object (small string optimization), as
+    std::string does, so all the names in this example stay off the heap.
+    benchmark.cpp measures construct/copy/move for both versions (build it with
+    -DSTRING_TRACE=0, see the Makefile, so the tracing output is compiled out).
+*/
+
 /*
     ============================
     Entity Ownership Semantics
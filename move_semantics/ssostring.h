@@ -0,0 +1,196 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string_view>
+#include <utility>
+#include "stringtrace.h"
+
+// String with the small string optimization (SSO): up to InlineCapacity
+// characters are stored inside the object itself, so short strings like "Matias"
+// never touch the heap. Longer strings own a heap buffer exactly as before, and
+// moving them still just steals the pointer.
+//
+// It is also a well-behaved value type for containers: the move operations are
+// noexcept (so std::vector moves instead of copying when it reallocates), copy
+// assignment uses copy-and-swap, and Append grows the buffer geometrically.
+class String
+{
+public:
+    static constexpr uint32_t InlineCapacity = 22;
+
+    String() = default;
+
+    String(const char* string)
+    {
+        STRING_LOG("Created!\n");
+        STRING_COUNT(Created);
+        Assign(string, strlen(string));
+    }
+
+    String(const String& other)
+    {
+        STRING_LOG("Copied!\n");
+        STRING_COUNT(Copied);
+        Assign(other.Data(), other.m_Size);
+    }
+
+    String(String&& other) noexcept
+    {
+        STRING_LOG("Moved!\n");
+        STRING_COUNT(Moved);
+        Steal(other);
+    }
+
+    // Copy-and-swap: the copy is made before *this is touched, so a failing
+    // allocation leaves *this unchanged (strong exception guarantee), and
+    // self-assignment needs no special case.
+    String& operator=(const String& other)
+    {
+        String copy(other);
+        Swap(copy);
+        return *this;
+    }
+
+    String& operator=(String&& other) noexcept
+    {
+        if(this != &other)
+        {
+            STRING_LOG("Moved!\n");
+            STRING_COUNT(Moved);
+            Release();
+            Steal(other);
+        }
+        return *this;
+    }
+
+    ~String()
+    {
+        STRING_LOG("Destroyed!\n");
+        Release();
+    }
+
+    void Swap(String& other) noexcept
+    {
+        // Bytewise swap is valid for both representations: an inline string owns no
+        // pointer into itself, and a heap string's pointer does not depend on where
+        // the String object lives.
+        char tmp[sizeof(String)];
+        memcpy(tmp, static_cast<void*>(this), sizeof(String));
+        memcpy(static_cast<void*>(this), static_cast<void*>(&other), sizeof(String));
+        memcpy(static_cast<void*>(&other), tmp, sizeof(String));
+    }
+
+    friend void swap(String& a, String& b) noexcept {a.Swap(b);}
+
+    void Reserve(uint32_t capacity)
+    {
+        if(capacity <= m_Capacity) return;
+        char* data = new char[capacity];
+        memcpy(data, Data(), m_Size);
+        if(!IsInline()) delete[] m_Heap;
+        m_Heap = data;
+        m_Capacity = capacity;
+    }
+
+    // Amortised O(1) per character: the capacity at least doubles when it runs out.
+    String& Append(std::string_view text)
+    {
+        uint32_t needed = m_Size + static_cast<uint32_t>(text.size());
+        if(needed > m_Capacity) Reserve(std::max(needed, 2 * m_Capacity));
+        memcpy(MutableData() + m_Size, text.data(), text.size());
+        m_Size = needed;
+        return *this;
+    }
+
+    String& operator+=(std::string_view text) {return Append(text);}
+
+    const char* Data() const {return IsInline() ? m_Inline : m_Heap;}
+    uint32_t Size() const {return m_Size;}
+    uint32_t Capacity() const {return m_Capacity;}
+    bool IsInline() const {return m_Capacity == InlineCapacity;}
+    std::string_view View() const {return {Data(), m_Size};}
+
+    friend bool operator==(const String& a, const String& b) {return a.View() == b.View();}
+
+    void Print() const
+    {
+        const char* data = Data();
+        for(uint32_t i = 0; i < m_Size; ++i)
+        {
+            std::cout << data[i];
+        }
+        std::cout << "\n";
+    }
+
+private:
+    char* MutableData() {return IsInline() ? m_Inline : m_Heap;}
+
+    void Assign(const char* string, size_t size)
+    {
+        m_Size = static_cast<uint32_t>(size);
+        if(m_Size > InlineCapacity)
+        {
+            m_Heap = new char[m_Size];
+            m_Capacity = m_Size;
+        }
+        memcpy(MutableData(), string, m_Size);
+    }
+
+    // Heap strings hand over their pointer; inline strings have to copy their
+    // bytes. Copying the whole fixed-size buffer compiles to a couple of register
+    // moves, cheaper than a variable-length memcpy of just m_Size bytes.
+    void Steal(String& other) noexcept
+    {
+        m_Size = other.m_Size;
+        m_Capacity = other.m_Capacity;
+        if(IsInline()) memcpy(m_Inline, other.m_Inline, InlineCapacity);
+        else m_Heap = other.m_Heap;
+        other.m_Size = 0;
+        other.m_Capacity = InlineCapacity; // back to an empty inline string: nothing left to free
+    }
+
+    void Release() noexcept
+    {
+        if(!IsInline()) delete[] m_Heap;
+        m_Size = 0;
+        m_Capacity = InlineCapacity;
+    }
+
+    union
+    {
+        char* m_Heap;                   // active when m_Capacity > InlineCapacity
+        char m_Inline[InlineCapacity];  // active otherwise
+    };
+    uint32_t m_Size{0};
+    uint32_t m_Capacity{InlineCapacity};
+};
+
+template <>
+struct std::hash<String>
+{
+    size_t operator()(const String& s) const noexcept {return std::hash<std::string_view>{}(s.View());}
+};
+
+/*
+Layout:
+    The union overlays the heap pointer with the inline buffer, and the capacity
+    decides which member is live (a reserved or appended-to string can be short
+    and still on the heap). sizeof(String) is 32 bytes, against 16 for the
+    heap-only version, but for short strings the data lives right next to the size,
+    in the same cache line, with no pointer to chase.
+
+Moves:
+    Moving a heap string is still O(1) pointer stealing. Moving an inline string
+    copies its bytes, since there is no pointer to steal. The moved-from string
+    is left empty, as before.
+
+Why noexcept on the moves?
+    When std::vector grows it has to transfer its elements to the new buffer. If
+    that could throw halfway, the vector could not restore its old state, so it
+    only moves when the move constructor is noexcept (std::move_if_noexcept) and
+    copies otherwise. Without noexcept, every reallocation deep-copies every
+    string. benchmark.cpp counts this for String and HeapString.
+*/
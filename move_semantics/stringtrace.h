@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <iostream>
+
+// Compile-time switch for the "Created!/Copied!/Moved!/Destroyed!" tracing of the
+// String classes. It is on by default so the examples in main.cpp narrate what
+// happens; benchmarks build with -DSTRING_TRACE=0 so printing does not dominate.
+#ifndef STRING_TRACE
+#define STRING_TRACE 1
+#endif
+
+#if STRING_TRACE
+#define STRING_LOG(msg) (std::cout << msg)
+#else
+#define STRING_LOG(msg) ((void)0)
+#endif
+
+// Event counters, so benchmarks can report how many copies and moves a container
+// performed without printing. A plain increment, not thread-safe; build with
+// -DSTRING_COUNTERS=0 to remove them.
+#ifndef STRING_COUNTERS
+#define STRING_COUNTERS 1
+#endif
+
+struct StringCounters
+{
+    inline static size_t Created{0};
+    inline static size_t Copied{0};
+    inline static size_t Moved{0};
+
+    static void Reset() {Created = Copied = Moved = 0;}
+};
+
+#if STRING_COUNTERS
+#define STRING_COUNT(event) (++StringCounters::event)
+#else
+#define STRING_COUNT(event) ((void)0)
+#endif